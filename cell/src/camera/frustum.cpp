@@ -0,0 +1,122 @@
+#include "frustum.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define FRUSTUM_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+void CullBoundsSoA::resize(size_t objectCount) {
+    count = objectCount;
+    for (std::vector<float>* array : { &centerX, &centerY, &centerZ, &radius, &extentX, &extentY, &extentZ }) {
+        array->resize(count + PADDING, 0.0f);
+    }
+}
+
+void CullBoundsSoA::set(size_t index, const glm::vec3& center, float sphereRadius, const glm::vec3& halfExtents) {
+    centerX[index] = center.x;
+    centerY[index] = center.y;
+    centerZ[index] = center.z;
+    radius[index] = sphereRadius;
+    extentX[index] = halfExtents.x;
+    extentY[index] = halfExtents.y;
+    extentZ[index] = halfExtents.z;
+}
+
+Frustum::Frustum() {
+    // Until extract is called nothing is culled
+    for (glm::vec4& plane : m_Planes) {
+        plane = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+}
+
+void Frustum::extract(const glm::mat4& viewProjection) {
+    // glm is column-major: row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+    auto row = [&](int i) {
+        return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    };
+
+    m_Planes[0] = row(3) + row(0);  // Left
+    m_Planes[1] = row(3) - row(0);  // Right
+    m_Planes[2] = row(3) + row(1);  // Bottom
+    m_Planes[3] = row(3) - row(1);  // Top
+    m_Planes[4] = row(3) + row(2);  // Near
+    m_Planes[5] = row(3) - row(2);  // Far
+
+    for (glm::vec4& plane : m_Planes) {
+        float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f) {
+            plane /= length;
+        }
+    }
+}
+
+bool Frustum::isVisible(const glm::vec3& center, float radius, const glm::vec3& halfExtents) const {
+    for (const glm::vec4& plane : m_Planes) {
+        glm::vec3 normal(plane);
+        float distance = glm::dot(normal, center) + plane.w;
+        float boxRadius = glm::dot(glm::abs(normal), halfExtents);
+        if (distance < -std::min(radius, boxRadius)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t Frustum::cull(const CullBoundsSoA& bounds, std::vector<uint32_t>& visible) const {
+    size_t firstVisible = visible.size();
+
+#ifdef FRUSTUM_SIMD_X86
+    __m128 planeX[PLANE_COUNT], planeY[PLANE_COUNT], planeZ[PLANE_COUNT], planeW[PLANE_COUNT];
+    __m128 absX[PLANE_COUNT], absY[PLANE_COUNT], absZ[PLANE_COUNT];
+    for (int p = 0; p < PLANE_COUNT; p++) {
+        planeX[p] = _mm_set1_ps(m_Planes[p].x);
+        planeY[p] = _mm_set1_ps(m_Planes[p].y);
+        planeZ[p] = _mm_set1_ps(m_Planes[p].z);
+        planeW[p] = _mm_set1_ps(m_Planes[p].w);
+        absX[p] = _mm_set1_ps(std::abs(m_Planes[p].x));
+        absY[p] = _mm_set1_ps(std::abs(m_Planes[p].y));
+        absZ[p] = _mm_set1_ps(std::abs(m_Planes[p].z));
+    }
+
+    for (size_t first = 0; first < bounds.count; first += 4) {
+        __m128 cx = _mm_loadu_ps(&bounds.centerX[first]);
+        __m128 cy = _mm_loadu_ps(&bounds.centerY[first]);
+        __m128 cz = _mm_loadu_ps(&bounds.centerZ[first]);
+        __m128 radius = _mm_loadu_ps(&bounds.radius[first]);
+        __m128 ex = _mm_loadu_ps(&bounds.extentX[first]);
+        __m128 ey = _mm_loadu_ps(&bounds.extentY[first]);
+        __m128 ez = _mm_loadu_ps(&bounds.extentZ[first]);
+
+        __m128 outside = _mm_setzero_ps();
+        for (int p = 0; p < PLANE_COUNT; p++) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], cx), _mm_mul_ps(planeY[p], cy)),
+                _mm_add_ps(_mm_mul_ps(planeZ[p], cz), planeW[p]));
+            __m128 boxRadius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absX[p], ex), _mm_mul_ps(absY[p], ey)), _mm_mul_ps(absZ[p], ez));
+            __m128 reach = _mm_min_ps(radius, boxRadius);
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, reach), _mm_setzero_ps()));
+        }
+
+        // Lanes past the end are padding
+        size_t lanes = std::min<size_t>(4, bounds.count - first);
+        int mask = ~_mm_movemask_ps(outside) & ((1 << lanes) - 1);
+        while (mask) {
+            int lane = 0;
+            while (!(mask & (1 << lane))) lane++;
+            visible.push_back(static_cast<uint32_t>(first + lane));
+            mask &= mask - 1;
+        }
+    }
+#else
+    for (size_t i = 0; i < bounds.count; i++) {
+        glm::vec3 center(bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i]);
+        glm::vec3 halfExtents(bounds.extentX[i], bounds.extentY[i], bounds.extentZ[i]);
+        if (isVisible(center, bounds.radius[i], halfExtents)) {
+            visible.push_back(static_cast<uint32_t>(i));
+        }
+    }
+#endif
+
+    return visible.size() - firstVisible;
+}
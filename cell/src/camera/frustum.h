@@ -0,0 +1,45 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// World-space bounds of many objects as structure-of-arrays, for culling them in batches.
+// Each object has a bounding sphere and an axis-aligned box sharing one center. Every array
+// carries PADDING extra entries so 4-wide loads at the tail stay in bounds.
+struct CullBoundsSoA {
+    static constexpr size_t PADDING = 4;
+
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> radius;
+    std::vector<float> extentX, extentY, extentZ;  // Box half extents
+    size_t count = 0;
+
+    // Sizes every array for count objects; entries are left for set()
+    void resize(size_t count);
+    void set(size_t index, const glm::vec3& center, float radius, const glm::vec3& halfExtents);
+};
+
+// The six planes of a view-projection volume, normals pointing inwards and normalized, so
+// dot(normal, p) + d is the signed distance of p from the plane, positive inside.
+class Frustum {
+private:
+    glm::vec4 m_Planes[6];
+
+public:
+    static constexpr int PLANE_COUNT = 6;
+
+    Frustum();
+
+    // Gribb-Hartmann extraction from the rows of an OpenGL (-1..1 depth) view-projection matrix
+    void extract(const glm::mat4& viewProjection);
+
+    // An object is outside when, for any plane, its center is further behind it than the smaller
+    // of its sphere radius and its box's projected half size; so both shapes must cut the
+    // frustum. Conservative: objects near a corner may be kept.
+    bool isVisible(const glm::vec3& center, float radius, const glm::vec3& halfExtents) const;
+
+    // Appends the index of every visible object to visible, 4 objects per iteration; returns how many
+    size_t cull(const CullBoundsSoA& bounds, std::vector<uint32_t>& visible) const;
+
+    const glm::vec4& getPlane(int index) const { return m_Planes[index]; }
+};
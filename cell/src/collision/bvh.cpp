@@ -0,0 +1,173 @@
+#include "bvh.h"
+#include <algorithm>
+#include <numeric>
+
+void BVH::build(const std::vector<CollisionBounds>& primitiveBounds) {
+    clear();
+    if (primitiveBounds.empty()) {
+        return;
+    }
+
+    uint32_t count = static_cast<uint32_t>(primitiveBounds.size());
+    m_PrimitiveIndices.resize(count);
+    std::iota(m_PrimitiveIndices.begin(), m_PrimitiveIndices.end(), 0u);
+
+    std::vector<glm::vec3> centroids(count);
+    for (uint32_t i = 0; i < count; i++) {
+        centroids[i] = primitiveBounds[i].getCenter();
+    }
+
+    // A full tree with leaves of MAX_LEAF_SIZE has about 2n / MAX_LEAF_SIZE nodes
+    m_Nodes.reserve(2 * (count / MAX_LEAF_SIZE + 1));
+    m_Nodes.push_back(BVHNode());
+    subdivide(0, 0, count, 0, primitiveBounds, centroids);
+}
+
+void BVH::subdivide(uint32_t nodeIndex, uint32_t first, uint32_t count, int depth,
+    const std::vector<CollisionBounds>& primitiveBounds, const std::vector<glm::vec3>& centroids) {
+    CollisionBounds bounds;
+    CollisionBounds centroidBounds;
+    for (uint32_t i = first; i < first + count; i++) {
+        uint32_t primitive = m_PrimitiveIndices[i];
+        bounds.grow(primitiveBounds[primitive]);
+        centroidBounds.grow(centroids[primitive]);
+    }
+
+    m_Nodes[nodeIndex].boundsMin = bounds.min;
+    m_Nodes[nodeIndex].boundsMax = bounds.max;
+
+    if (count <= MAX_LEAF_SIZE) {
+        m_Nodes[nodeIndex].offset = first;
+        m_Nodes[nodeIndex].count = count;
+        return;
+    }
+
+    auto primitivesBegin = m_PrimitiveIndices.begin() + first;
+    auto primitivesEnd = primitivesBegin + count;
+    uint32_t leftCount = 0;
+
+    // Binned SAH: bucket centroids per axis and pick the cheapest bucket boundary
+    if (depth < MAX_SAH_DEPTH) {
+        struct Bin {
+            CollisionBounds bounds;
+            uint32_t count = 0;
+        };
+
+        float bestCost = std::numeric_limits<float>::max();
+        int bestAxis = -1;
+        int bestSplit = 0;
+
+        // All three axes are binned in one pass so each primitive is fetched once
+        Bin bins[3][BIN_COUNT];
+        glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+        glm::vec3 scale(0.0f);
+        for (int axis = 0; axis < 3; axis++) {
+            scale[axis] = extent[axis] > 0.0f ? BIN_COUNT / extent[axis] : 0.0f;
+        }
+
+        for (uint32_t i = first; i < first + count; i++) {
+            uint32_t primitive = m_PrimitiveIndices[i];
+            const CollisionBounds& primitiveBox = primitiveBounds[primitive];
+            for (int axis = 0; axis < 3; axis++) {
+                int bin = std::min(BIN_COUNT - 1, static_cast<int>((centroids[primitive][axis] - centroidBounds.min[axis]) * scale[axis]));
+                bins[axis][bin].count++;
+                bins[axis][bin].bounds.grow(primitiveBox);
+            }
+        }
+
+        for (int axis = 0; axis < 3; axis++) {
+            if (extent[axis] <= 0.0f) {
+                continue;
+            }
+
+            // Left-to-right sweep stores the cost terms of every prefix
+            float leftCost[BIN_COUNT - 1];
+            uint32_t leftCounts[BIN_COUNT - 1];
+            CollisionBounds leftBounds;
+            uint32_t leftSum = 0;
+            for (int i = 0; i < BIN_COUNT - 1; i++) {
+                leftSum += bins[axis][i].count;
+                leftBounds.grow(bins[axis][i].bounds);
+                leftCounts[i] = leftSum;
+                leftCost[i] = leftSum > 0 ? leftSum * leftBounds.getSurfaceArea() : 0.0f;
+            }
+
+            // Right-to-left sweep completes each candidate split
+            CollisionBounds rightBounds;
+            uint32_t rightSum = 0;
+            for (int i = BIN_COUNT - 1; i > 0; i--) {
+                rightSum += bins[axis][i].count;
+                rightBounds.grow(bins[axis][i].bounds);
+                if (leftCounts[i - 1] == 0 || rightSum == 0) {
+                    continue;
+                }
+
+                float cost = leftCost[i - 1] + rightSum * rightBounds.getSurfaceArea();
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = i;
+                }
+            }
+        }
+
+        if (bestAxis >= 0) {
+            float minimum = centroidBounds.min[bestAxis];
+            float axisScale = scale[bestAxis];
+            auto middle = std::partition(primitivesBegin, primitivesEnd, [&](uint32_t primitive) {
+                int bin = std::min(BIN_COUNT - 1, static_cast<int>((centroids[primitive][bestAxis] - minimum) * axisScale));
+                return bin < bestSplit;
+            });
+            leftCount = static_cast<uint32_t>(middle - primitivesBegin);
+        }
+    }
+
+    // Too deep or no usable SAH split: halve at the object median of the widest axis
+    if (leftCount == 0 || leftCount == count) {
+        glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+        int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+        leftCount = count / 2;
+        std::nth_element(primitivesBegin, primitivesBegin + leftCount, primitivesEnd, [&](uint32_t a, uint32_t b) {
+            return centroids[a][axis] < centroids[b][axis];
+        });
+    }
+
+    // Depth-first layout: the left child is always the next node
+    uint32_t leftIndex = static_cast<uint32_t>(m_Nodes.size());
+    m_Nodes.push_back(BVHNode());
+    subdivide(leftIndex, first, leftCount, depth + 1, primitiveBounds, centroids);
+
+    uint32_t rightIndex = static_cast<uint32_t>(m_Nodes.size());
+    m_Nodes.push_back(BVHNode());
+    m_Nodes[nodeIndex].offset = rightIndex;
+    m_Nodes[nodeIndex].count = 0;
+    subdivide(rightIndex, first + leftCount, count - leftCount, depth + 1, primitiveBounds, centroids);
+}
+
+void BVH::refit(const std::vector<CollisionBounds>& primitiveBounds) {
+    // Children always come after their parent, so a reverse sweep is bottom-up
+    for (size_t i = m_Nodes.size(); i-- > 0;) {
+        BVHNode& node = m_Nodes[i];
+        CollisionBounds bounds;
+
+        if (node.isLeaf()) {
+            for (uint32_t j = 0; j < node.count; j++) {
+                bounds.grow(primitiveBounds[m_PrimitiveIndices[node.offset + j]]);
+            }
+        }
+        else {
+            const BVHNode& left = m_Nodes[i + 1];
+            const BVHNode& right = m_Nodes[node.offset];
+            bounds.min = glm::min(left.boundsMin, right.boundsMin);
+            bounds.max = glm::max(left.boundsMax, right.boundsMax);
+        }
+
+        node.boundsMin = bounds.min;
+        node.boundsMax = bounds.max;
+    }
+}
+
+void BVH::clear() {
+    m_Nodes.clear();
+    m_PrimitiveIndices.clear();
+}
@@ -0,0 +1,232 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Axis-aligned box shared by the collision structures
+struct CollisionBounds {
+    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+    void grow(const glm::vec3& point) {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    void grow(const CollisionBounds& other) {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    bool overlaps(const CollisionBounds& other) const {
+        return min.x <= other.max.x && max.x >= other.min.x &&
+            min.y <= other.max.y && max.y >= other.min.y &&
+            min.z <= other.max.z && max.z >= other.min.z;
+    }
+
+    bool isEmpty() const { return min.x > max.x; }
+    glm::vec3 getCenter() const { return (min + max) * 0.5f; }
+
+    float getSurfaceArea() const {
+        glm::vec3 extent = max - min;
+        return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+    }
+};
+
+// Conservative box around bounds after an affine transform
+inline CollisionBounds transformBounds(const CollisionBounds& bounds, const glm::mat4& transform) {
+    glm::vec3 center = glm::vec3(transform * glm::vec4(bounds.getCenter(), 1.0f));
+    glm::vec3 halfExtent = (bounds.max - bounds.min) * 0.5f;
+
+    // Each output half-extent is the absolute row of the 3x3 part dotted with the input
+    glm::vec3 newHalfExtent(0.0f);
+    for (int column = 0; column < 3; column++) {
+        newHalfExtent += glm::abs(glm::vec3(transform[column])) * halfExtent[column];
+    }
+
+    CollisionBounds result;
+    result.min = center - newHalfExtent;
+    result.max = center + newHalfExtent;
+    return result;
+}
+
+// 32 bytes, two per cache line. Nodes are stored depth-first: an interior node's
+// left child directly follows it, so only the right child's index is kept.
+struct BVHNode {
+    glm::vec3 boundsMin;
+    uint32_t offset;  // Interior: index of the right child. Leaf: first slot in the primitive index list
+    glm::vec3 boundsMax;
+    uint32_t count;   // Primitives in a leaf, 0 for interior nodes
+
+    bool isLeaf() const { return count != 0; }
+};
+
+// Bounding volume hierarchy over arbitrary boxes (triangles, model instances, ...),
+// built with binned surface area heuristic splits.
+class BVH {
+private:
+    std::vector<BVHNode> m_Nodes;
+    std::vector<uint32_t> m_PrimitiveIndices;  // Leaf order; leaves reference contiguous runs
+
+    void subdivide(uint32_t nodeIndex, uint32_t first, uint32_t count, int depth,
+        const std::vector<CollisionBounds>& primitiveBounds, const std::vector<glm::vec3>& centroids);
+
+public:
+    static constexpr uint32_t MAX_LEAF_SIZE = 4;
+    static constexpr int BIN_COUNT = 16;
+    // Deeper than this, splits fall back to the object median, which bounds total depth
+    static constexpr int MAX_SAH_DEPTH = 96;
+    static constexpr int STACK_SIZE = 128;
+
+    void build(const std::vector<CollisionBounds>& primitiveBounds);
+    // Recomputes node bounds after primitives moved; topology is kept
+    void refit(const std::vector<CollisionBounds>& primitiveBounds);
+    void clear();
+
+    // Calls visit(primitiveIndex) for every primitive in a leaf overlapping bounds
+    template <typename Visitor>
+    void query(const CollisionBounds& bounds, Visitor&& visit) const;
+
+    // Calls visit(first, count) with the slot range of every leaf overlapping bounds. Callers that
+    // store their primitives in getPrimitiveIndices() order can use slots as primitive indices.
+    template <typename Visitor>
+    void queryLeaves(const CollisionBounds& bounds, Visitor&& visit) const;
+
+    // Calls visit(first, count) for every leaf the ray origin + t * direction, 0 <= t <= maxDistance,
+    // passes through, nearer children first. visit returns the distance still worth searching, so a
+    // closest-hit search shrinks it as hits come in and subtrees beyond it are never entered.
+    template <typename Visitor>
+    void queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Visitor&& visit) const;
+
+    bool isEmpty() const { return m_Nodes.empty(); }
+    size_t getMemoryUsage() const {
+        return m_Nodes.capacity() * sizeof(BVHNode) + m_PrimitiveIndices.capacity() * sizeof(uint32_t);
+    }
+    const std::vector<BVHNode>& getNodes() const { return m_Nodes; }
+    const std::vector<uint32_t>& getPrimitiveIndices() const { return m_PrimitiveIndices; }
+};
+
+template <typename Visitor>
+void BVH::query(const CollisionBounds& bounds, Visitor&& visit) const {
+    queryLeaves(bounds, [&](uint32_t first, uint32_t count) {
+        for (uint32_t i = first; i < first + count; i++) {
+            visit(m_PrimitiveIndices[i]);
+        }
+    });
+}
+
+template <typename Visitor>
+void BVH::queryLeaves(const CollisionBounds& bounds, Visitor&& visit) const {
+    if (m_Nodes.empty()) {
+        return;
+    }
+
+    uint32_t stack[STACK_SIZE];
+    int stackSize = 0;
+    uint32_t nodeIndex = 0;
+
+    while (true) {
+        const BVHNode& node = m_Nodes[nodeIndex];
+        bool overlaps = node.boundsMin.x <= bounds.max.x && node.boundsMax.x >= bounds.min.x &&
+            node.boundsMin.y <= bounds.max.y && node.boundsMax.y >= bounds.min.y &&
+            node.boundsMin.z <= bounds.max.z && node.boundsMax.z >= bounds.min.z;
+
+        if (overlaps) {
+            if (node.isLeaf()) {
+                visit(node.offset, node.count);
+            }
+            else {
+                // Descend left, come back for the right child later
+                stack[stackSize++] = node.offset;
+                nodeIndex++;
+                continue;
+            }
+        }
+
+        if (stackSize == 0) {
+            break;
+        }
+        nodeIndex = stack[--stackSize];
+    }
+}
+
+// Slab test: distance at which the ray enters box, or infinity if it misses within maxDistance.
+// inverseDirection must have no infinite components.
+inline float intersectRayBounds(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance,
+    const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+    glm::vec3 t0 = (boundsMin - origin) * inverseDirection;
+    glm::vec3 t1 = (boundsMax - origin) * inverseDirection;
+    glm::vec3 near = glm::min(t0, t1);
+    glm::vec3 far = glm::max(t0, t1);
+    float enter = std::max(std::max(near.x, near.y), std::max(near.z, 0.0f));
+    float exit = std::min(std::min(far.x, far.y), std::min(far.z, maxDistance));
+    return enter <= exit ? enter : std::numeric_limits<float>::infinity();
+}
+
+// 1 / direction with zero components replaced by a tiny signed value, so slab tests stay finite
+inline glm::vec3 getSafeInverseDirection(const glm::vec3& direction) {
+    glm::vec3 inverse;
+    for (int axis = 0; axis < 3; axis++) {
+        float component = std::abs(direction[axis]) < 1e-20f ? std::copysign(1e-20f, direction[axis]) : direction[axis];
+        inverse[axis] = 1.0f / component;
+    }
+    return inverse;
+}
+
+template <typename Visitor>
+void BVH::queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Visitor&& visit) const {
+    if (m_Nodes.empty()) {
+        return;
+    }
+
+    glm::vec3 inverseDirection = getSafeInverseDirection(direction);
+    if (intersectRayBounds(origin, inverseDirection, maxDistance, m_Nodes[0].boundsMin, m_Nodes[0].boundsMax) > maxDistance) {
+        return;
+    }
+
+    // Deferred far children with their entry distance, so ones beyond a later hit are dropped when popped
+    struct StackEntry {
+        uint32_t node;
+        float distance;
+    };
+    StackEntry stack[STACK_SIZE];
+    int stackSize = 0;
+    uint32_t nodeIndex = 0;
+
+    while (true) {
+        const BVHNode& node = m_Nodes[nodeIndex];
+        if (node.isLeaf()) {
+            maxDistance = visit(node.offset, node.count);
+        }
+        else {
+            uint32_t near = nodeIndex + 1;
+            uint32_t far = node.offset;
+            float nearDistance = intersectRayBounds(origin, inverseDirection, maxDistance, m_Nodes[near].boundsMin, m_Nodes[near].boundsMax);
+            float farDistance = intersectRayBounds(origin, inverseDirection, maxDistance, m_Nodes[far].boundsMin, m_Nodes[far].boundsMax);
+            if (farDistance < nearDistance) {
+                std::swap(near, far);
+                std::swap(nearDistance, farDistance);
+            }
+
+            if (nearDistance <= maxDistance) {
+                if (farDistance <= maxDistance) {
+                    stack[stackSize++] = { far, farDistance };
+                }
+                nodeIndex = near;
+                continue;
+            }
+        }
+
+        // Pop the next subtree that still starts within reach
+        while (stackSize > 0 && stack[stackSize - 1].distance > maxDistance) {
+            stackSize--;
+        }
+        if (stackSize == 0) {
+            break;
+        }
+        nodeIndex = stack[--stackSize].node;
+    }
+}
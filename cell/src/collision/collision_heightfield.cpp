@@ -0,0 +1,285 @@
+#include "collision_heightfield.h"
+#include "ray_kernel.h"
+#include <algorithm>
+#include <limits>
+
+bool CollisionHeightfield::build(const glm::vec2& origin, const glm::vec2& cellSize, uint32_t columns, uint32_t rows,
+    std::vector<float> heights) {
+    if (columns < 2 || rows < 2 || cellSize.x <= 0.0f || cellSize.y <= 0.0f ||
+        heights.size() != static_cast<size_t>(columns) * rows) {
+        return false;
+    }
+
+    m_Origin = origin;
+    m_CellSize = cellSize;
+    m_Columns = columns;
+    m_Rows = rows;
+    m_Heights = std::move(heights);
+    m_FlippedCells.assign(static_cast<size_t>(columns - 1) * (rows - 1), 0);
+    computeBounds();
+    return true;
+}
+
+bool CollisionHeightfield::detect(const std::vector<float>& vertices, size_t vertexStride, const std::vector<unsigned int>& indices) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2 || indices.size() % 3 != 0) {
+        return false;
+    }
+
+    auto position = [&](unsigned int index) {
+        return glm::vec3(vertices[index * vertexStride], vertices[index * vertexStride + 1], vertices[index * vertexStride + 2]);
+    };
+
+    // Cell size from the first triangle, which spans exactly one cell in x and z if this is a grid
+    glm::vec3 first[3] = { position(indices[0]), position(indices[1]), position(indices[2]) };
+    glm::vec2 cellSize(0.0f);
+    for (int a = 0; a < 3; a++) {
+        for (int b = 0; b < 3; b++) {
+            cellSize.x = std::max(cellSize.x, first[a].x - first[b].x);
+            cellSize.y = std::max(cellSize.y, first[a].z - first[b].z);
+        }
+    }
+    if (cellSize.x <= 0.0f || cellSize.y <= 0.0f) {
+        return false;
+    }
+
+    glm::vec2 gridMin(std::numeric_limits<float>::max());
+    glm::vec2 gridMax(-std::numeric_limits<float>::max());
+    for (unsigned int index : indices) {
+        glm::vec3 p = position(index);
+        gridMin = glm::min(gridMin, glm::vec2(p.x, p.z));
+        gridMax = glm::max(gridMax, glm::vec2(p.x, p.z));
+    }
+
+    glm::vec2 cellCount = glm::round((gridMax - gridMin) / cellSize);
+    uint32_t columns = static_cast<uint32_t>(cellCount.x) + 1;
+    uint32_t rows = static_cast<uint32_t>(cellCount.y) + 1;
+    if (static_cast<size_t>(columns - 1) * (rows - 1) * 2 != triangleCount) {
+        return false;
+    }
+
+    // Snaps a vertex to its grid point; false if it lies between points
+    float heightTolerance = GRID_TOLERANCE * std::max(cellSize.x, cellSize.y);
+    auto toGrid = [&](const glm::vec3& p, uint32_t& column, uint32_t& row) {
+        glm::vec2 grid = (glm::vec2(p.x, p.z) - gridMin) / cellSize;
+        glm::vec2 rounded = glm::round(grid);
+        if (std::abs(grid.x - rounded.x) > GRID_TOLERANCE || std::abs(grid.y - rounded.y) > GRID_TOLERANCE) {
+            return false;
+        }
+        column = static_cast<uint32_t>(rounded.x);
+        row = static_cast<uint32_t>(rounded.y);
+        return true;
+    };
+
+    std::vector<float> heights(static_cast<size_t>(columns) * rows, std::numeric_limits<float>::quiet_NaN());
+    // Per cell, one bit for each corner a triangle left out; a split cell ends up with 0b1001 or 0b0110
+    std::vector<uint8_t> missingCorners(static_cast<size_t>(columns - 1) * (rows - 1), 0);
+
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        uint32_t column[3], row[3];
+        for (int v = 0; v < 3; v++) {
+            glm::vec3 p = position(indices[i + v]);
+            if (!toGrid(p, column[v], row[v])) {
+                return false;
+            }
+
+            // One height per grid point: no overhangs or vertical walls
+            float& height = heights[row[v] * columns + column[v]];
+            if (std::isnan(height)) {
+                height = p.y;
+            }
+            else if (std::abs(height - p.y) > heightTolerance) {
+                return false;
+            }
+        }
+
+        uint32_t cellColumn = std::min({ column[0], column[1], column[2] });
+        uint32_t cellRow = std::min({ row[0], row[1], row[2] });
+        if (cellColumn >= columns - 1 || cellRow >= rows - 1) {
+            return false;
+        }
+
+        uint8_t corners = 0;
+        for (int v = 0; v < 3; v++) {
+            uint32_t dx = column[v] - cellColumn;
+            uint32_t dz = row[v] - cellRow;
+            if (dx > 1 || dz > 1) {
+                return false;
+            }
+            corners |= 1 << (dx + 2 * dz);
+        }
+        uint8_t missing = ~corners & 0xF;
+        // Three distinct corners leave exactly one out
+        if ((missing & (missing - 1)) != 0) {
+            return false;
+        }
+        missingCorners[cellRow * (columns - 1) + cellColumn] |= missing;
+    }
+
+    std::vector<uint8_t> flippedCells(missingCorners.size());
+    for (size_t cell = 0; cell < missingCorners.size(); cell++) {
+        // Corners (0, 0) and (1, 1) left out: split along (1, 0) to (0, 1)
+        if (missingCorners[cell] == 0b1001) {
+            flippedCells[cell] = 1;
+        }
+        else if (missingCorners[cell] != 0b0110) {
+            return false;
+        }
+    }
+
+    m_Origin = gridMin;
+    m_CellSize = cellSize;
+    m_Columns = columns;
+    m_Rows = rows;
+    m_Heights = std::move(heights);
+    m_FlippedCells = std::move(flippedCells);
+    computeBounds();
+    return true;
+}
+
+void CollisionHeightfield::computeBounds() {
+    m_Bounds = CollisionBounds();
+    if (m_Heights.empty()) {
+        return;
+    }
+
+    auto [lowest, highest] = std::minmax_element(m_Heights.begin(), m_Heights.end());
+    m_Bounds.min = glm::vec3(m_Origin.x, *lowest, m_Origin.y);
+    m_Bounds.max = glm::vec3(m_Origin.x + m_CellSize.x * (m_Columns - 1), *highest, m_Origin.y + m_CellSize.y * (m_Rows - 1));
+}
+
+bool CollisionHeightfield::getHeight(float x, float z, float& height) const {
+    if (m_FlippedCells.empty()) {
+        return false;
+    }
+
+    float u = (x - m_Origin.x) / m_CellSize.x;
+    float v = (z - m_Origin.y) / m_CellSize.y;
+    if (u < 0.0f || v < 0.0f || u > m_Columns - 1 || v > m_Rows - 1) {
+        return false;
+    }
+
+    uint32_t column = std::min(static_cast<uint32_t>(u), m_Columns - 2);
+    uint32_t row = std::min(static_cast<uint32_t>(v), m_Rows - 2);
+    float fu = u - column;
+    float fv = v - row;
+
+    float h00 = getGridHeight(column, row);
+    float h10 = getGridHeight(column + 1, row);
+    float h01 = getGridHeight(column, row + 1);
+    float h11 = getGridHeight(column + 1, row + 1);
+
+    // Interpolate on the half of the cell that contains the point
+    if (m_FlippedCells[row * (m_Columns - 1) + column]) {
+        height = fu + fv <= 1.0f
+            ? h00 + fu * (h10 - h00) + fv * (h01 - h00)
+            : h11 + (1.0f - fu) * (h01 - h11) + (1.0f - fv) * (h10 - h11);
+    }
+    else {
+        height = fu >= fv
+            ? h00 + fu * (h10 - h00) + fv * (h11 - h10)
+            : h00 + fv * (h01 - h00) + fu * (h11 - h01);
+    }
+    return true;
+}
+
+bool CollisionHeightfield::raycast(const glm::vec3& origin, const glm::vec3& direction, float& distance, uint32_t& triangle) const {
+    if (m_FlippedCells.empty()) {
+        return false;
+    }
+
+    // Clip the ray to the grid's bounds
+    float enter = intersectRayBounds(origin, getSafeInverseDirection(direction), distance, m_Bounds.min, m_Bounds.max);
+    if (enter > distance) {
+        return false;
+    }
+
+    // Cell-by-cell walk over xz from the entry point, after Amanatides and Woo
+    glm::vec3 entry = origin + direction * enter;
+    int column = std::clamp(static_cast<int>(std::floor((entry.x - m_Origin.x) / m_CellSize.x)), 0, static_cast<int>(m_Columns) - 2);
+    int row = std::clamp(static_cast<int>(std::floor((entry.z - m_Origin.y) / m_CellSize.y)), 0, static_cast<int>(m_Rows) - 2);
+
+    const float infinity = std::numeric_limits<float>::infinity();
+    int stepColumn = direction.x > 0.0f ? 1 : -1;
+    int stepRow = direction.z > 0.0f ? 1 : -1;
+    float nextColumnDistance = direction.x != 0.0f
+        ? (m_Origin.x + (column + (stepColumn > 0 ? 1 : 0)) * m_CellSize.x - origin.x) / direction.x : infinity;
+    float nextRowDistance = direction.z != 0.0f
+        ? (m_Origin.y + (row + (stepRow > 0 ? 1 : 0)) * m_CellSize.y - origin.z) / direction.z : infinity;
+    float columnStep = direction.x != 0.0f ? m_CellSize.x / std::abs(direction.x) : infinity;
+    float rowStep = direction.z != 0.0f ? m_CellSize.y / std::abs(direction.z) : infinity;
+
+    float cellEnter = enter;
+    while (true) {
+        float cellExit = std::min(std::min(nextColumnDistance, nextRowDistance), distance);
+
+        // Skip cells the ray passes entirely above or below
+        float h00 = getGridHeight(column, row);
+        float h10 = getGridHeight(column + 1, row);
+        float h01 = getGridHeight(column, row + 1);
+        float h11 = getGridHeight(column + 1, row + 1);
+        float rayEnterY = origin.y + direction.y * cellEnter;
+        float rayExitY = origin.y + direction.y * cellExit;
+        if (std::max(rayEnterY, rayExitY) >= std::min(std::min(h00, h10), std::min(h01, h11)) &&
+            std::min(rayEnterY, rayExitY) <= std::max(std::max(h00, h10), std::max(h01, h11))) {
+            // Both halves lie inside this cell, so the first cell with a hit holds the closest one
+            uint32_t cell = static_cast<uint32_t>(row) * (m_Columns - 1) + column;
+            bool found = false;
+            for (uint32_t half = 0; half < 2; half++) {
+                if (RayKernel::intersectTriangle(getTriangle(cell * 2 + half), origin, direction, distance)) {
+                    triangle = cell * 2 + half;
+                    found = true;
+                }
+            }
+            if (found) {
+                return true;
+            }
+        }
+
+        if (cellExit >= distance) {
+            return false;
+        }
+        if (nextColumnDistance < nextRowDistance) {
+            column += stepColumn;
+            if (column < 0 || column > static_cast<int>(m_Columns) - 2) {
+                return false;
+            }
+            cellEnter = nextColumnDistance;
+            nextColumnDistance += columnStep;
+        }
+        else {
+            row += stepRow;
+            if (row < 0 || row > static_cast<int>(m_Rows) - 2) {
+                return false;
+            }
+            cellEnter = nextRowDistance;
+            nextRowDistance += rowStep;
+        }
+    }
+}
+
+CollisionTriangle CollisionHeightfield::getTriangle(uint32_t index) const {
+    uint32_t cell = index / 2;
+    uint32_t column = cell % (m_Columns - 1);
+    uint32_t row = cell / (m_Columns - 1);
+
+    auto corner = [&](uint32_t dx, uint32_t dz) {
+        return glm::vec3(m_Origin.x + (column + dx) * m_CellSize.x, getGridHeight(column + dx, row + dz),
+            m_Origin.y + (row + dz) * m_CellSize.y);
+    };
+
+    // Both halves wound so their normals point up
+    CollisionTriangle triangle;
+    if (m_FlippedCells[cell]) {
+        triangle.v0 = index % 2 == 0 ? corner(0, 0) : corner(1, 0);
+        triangle.v1 = corner(0, 1);
+        triangle.v2 = index % 2 == 0 ? corner(1, 0) : corner(1, 1);
+    }
+    else {
+        triangle.v0 = corner(0, 0);
+        triangle.v1 = index % 2 == 0 ? corner(1, 1) : corner(0, 1);
+        triangle.v2 = index % 2 == 0 ? corner(1, 0) : corner(1, 1);
+    }
+    triangle.normal = glm::normalize(glm::cross(triangle.v1 - triangle.v0, triangle.v2 - triangle.v0));
+    return triangle;
+}
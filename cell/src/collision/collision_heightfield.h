@@ -0,0 +1,90 @@
+#pragma once
+#include "bvh.h"
+#include "collision_triangle.h"
+#include <glm/glm.hpp>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Regular grid of heights over the xz plane, two triangles per cell. Replaces the triangle
+// BVH for terrain-like meshes: the cells under a box are found by division, so queries
+// cost O(1) per covered cell, and storage is one float per grid point instead of the full
+// per-triangle SAT data. Triangle index 2 * cell + half, cells row-major along x.
+class CollisionHeightfield {
+private:
+    glm::vec2 m_Origin = glm::vec2(0.0f);    // xz of grid point (0, 0)
+    glm::vec2 m_CellSize = glm::vec2(1.0f);
+    uint32_t m_Columns = 0;                  // Grid points along x
+    uint32_t m_Rows = 0;                     // Grid points along z
+    std::vector<float> m_Heights;            // m_Rows * m_Columns, row-major
+    std::vector<uint8_t> m_FlippedCells;     // 1 where the cell is split from (1, 0) to (0, 1) instead of (0, 0) to (1, 1)
+    CollisionBounds m_Bounds;
+
+    float getGridHeight(uint32_t column, uint32_t row) const { return m_Heights[row * m_Columns + column]; }
+    void computeBounds();
+
+public:
+    // Vertices within this fraction of a cell of a grid point snap to it
+    static constexpr float GRID_TOLERANCE = 1e-3f;
+
+    // Authored grid: heights row-major, columns x rows points, every cell split from (0, 0) to (1, 1)
+    bool build(const glm::vec2& origin, const glm::vec2& cellSize, uint32_t columns, uint32_t rows, std::vector<float> heights);
+
+    // Succeeds if the mesh is exactly a regular xz grid: one height per grid point and two
+    // triangles covering each cell. Anything else (walls, overhangs, holes) is left to the BVH.
+    bool detect(const std::vector<float>& vertices, size_t vertexStride, const std::vector<unsigned int>& indices);
+
+    // Calls visit(triangleIndex, triangle) for the triangles of every cell under bounds whose
+    // heights reach into it
+    template <typename Visitor>
+    void query(const CollisionBounds& bounds, Visitor&& visit) const;
+
+    // Surface height at (x, z); false outside the grid
+    bool getHeight(float x, float z, float& height) const;
+
+    // Closest hit of origin + t * direction with 0 <= t < distance; updates distance and triangle.
+    // Walks only the cells under the ray, in order, so it stops at the first cell that is hit.
+    bool raycast(const glm::vec3& origin, const glm::vec3& direction, float& distance, uint32_t& triangle) const;
+
+    CollisionTriangle getTriangle(uint32_t index) const;
+    size_t getTriangleCount() const { return m_FlippedCells.size() * 2; }
+    const CollisionBounds& getBounds() const { return m_Bounds; }
+    size_t getMemoryUsage() const { return m_Heights.capacity() * sizeof(float) + m_FlippedCells.capacity(); }
+};
+
+template <typename Visitor>
+void CollisionHeightfield::query(const CollisionBounds& bounds, Visitor&& visit) const {
+    if (m_FlippedCells.empty() || !m_Bounds.overlaps(bounds)) {
+        return;
+    }
+
+    // Covered cells, clamped to the grid; bounds already overlap it
+    uint32_t lastColumn = m_Columns - 2;
+    uint32_t lastRow = m_Rows - 2;
+    auto toCell = [](float coordinate, float origin, float size, uint32_t last) {
+        float cell = std::floor((coordinate - origin) / size);
+        return static_cast<uint32_t>(std::min(std::max(cell, 0.0f), static_cast<float>(last)));
+    };
+    uint32_t firstX = toCell(bounds.min.x, m_Origin.x, m_CellSize.x, lastColumn);
+    uint32_t endX = toCell(bounds.max.x, m_Origin.x, m_CellSize.x, lastColumn);
+    uint32_t firstZ = toCell(bounds.min.z, m_Origin.y, m_CellSize.y, lastRow);
+    uint32_t endZ = toCell(bounds.max.z, m_Origin.y, m_CellSize.y, lastRow);
+
+    for (uint32_t row = firstZ; row <= endZ; row++) {
+        for (uint32_t column = firstX; column <= endX; column++) {
+            float h00 = getGridHeight(column, row);
+            float h10 = getGridHeight(column + 1, row);
+            float h01 = getGridHeight(column, row + 1);
+            float h11 = getGridHeight(column + 1, row + 1);
+            float cellMin = std::min(std::min(h00, h10), std::min(h01, h11));
+            float cellMax = std::max(std::max(h00, h10), std::max(h01, h11));
+            if (cellMin > bounds.max.y || cellMax < bounds.min.y) {
+                continue;
+            }
+
+            uint32_t cell = row * (m_Columns - 1) + column;
+            visit(cell * 2, getTriangle(cell * 2));
+            visit(cell * 2 + 1, getTriangle(cell * 2 + 1));
+        }
+    }
+}
@@ -0,0 +1,182 @@
+#include "collision_mesh.h"
+#include "ray_kernel.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // Only positions and topology matter to collision, so normals and UVs are skipped
+    uint64_t hashGeometry(const std::vector<float>& vertices, size_t vertexStride, const std::vector<unsigned int>& indices) {
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i + 2 < vertices.size(); i += vertexStride) {
+            hash = hashBytes(hash, &vertices[i], 3 * sizeof(float));
+        }
+        return hashBytes(hash, indices.data(), indices.size() * sizeof(unsigned int));
+    }
+}
+
+void CollisionMesh::build(const std::vector<float>& vertices, size_t vertexStride, const std::vector<unsigned int>& indices,
+    bool allowHeightfield) {
+    // Terrain-like meshes skip the per-triangle data altogether
+    if (allowHeightfield) {
+        CollisionHeightfield heightfield;
+        if (heightfield.detect(vertices, vertexStride, indices)) {
+            build(std::move(heightfield));
+            return;
+        }
+    }
+    m_Heightfield.reset();
+
+    std::vector<CollisionTriangle> triangles;
+    triangles.reserve(indices.size() / 3);
+    std::vector<CollisionBounds> triangleBounds;
+    triangleBounds.reserve(indices.size() / 3);
+
+    m_Bounds = CollisionBounds();
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        CollisionTriangle triangle;
+        triangle.v0 = glm::vec3(vertices[indices[i] * vertexStride], vertices[indices[i] * vertexStride + 1], vertices[indices[i] * vertexStride + 2]);
+        triangle.v1 = glm::vec3(vertices[indices[i + 1] * vertexStride], vertices[indices[i + 1] * vertexStride + 1], vertices[indices[i + 1] * vertexStride + 2]);
+        triangle.v2 = glm::vec3(vertices[indices[i + 2] * vertexStride], vertices[indices[i + 2] * vertexStride + 1], vertices[indices[i + 2] * vertexStride + 2]);
+
+        // Slivers and collapsed faces can never be resolved against, so they are dropped here
+        if (CollisionTriangleSoA::isDegenerate(triangle)) {
+            continue;
+        }
+
+        // Calculate triangle normal
+        glm::vec3 edge1 = triangle.v1 - triangle.v0;
+        glm::vec3 edge2 = triangle.v2 - triangle.v0;
+        triangle.normal = glm::normalize(glm::cross(edge1, edge2));
+
+        CollisionBounds bounds;
+        bounds.grow(triangle.v0);
+        bounds.grow(triangle.v1);
+        bounds.grow(triangle.v2);
+        m_Bounds.grow(bounds);
+
+        triangles.push_back(triangle);
+        triangleBounds.push_back(bounds);
+    }
+
+    m_BVH.build(triangleBounds);
+
+    // Store triangles in leaf order so each leaf reads one contiguous run
+    const std::vector<uint32_t>& order = m_BVH.getPrimitiveIndices();
+    std::vector<CollisionTriangle> ordered(triangles.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        ordered[i] = triangles[order[i]];
+    }
+
+    // Release the build copies before the SoA, the largest allocation, is made
+    std::vector<CollisionTriangle>().swap(triangles);
+    std::vector<CollisionBounds>().swap(triangleBounds);
+    m_Triangles.assign(ordered);
+}
+
+void CollisionMesh::build(CollisionHeightfield heightfield) {
+    m_Triangles.clear();
+    m_BVH.clear();
+    m_Bounds = heightfield.getBounds();
+    m_Heightfield = std::make_unique<CollisionHeightfield>(std::move(heightfield));
+}
+
+bool CollisionMesh::raycast(const glm::vec3& origin, const glm::vec3& direction, float& distance, uint32_t& triangle) const {
+    if (m_Heightfield) {
+        return m_Heightfield->raycast(origin, direction, distance, triangle);
+    }
+
+    bool found = false;
+    m_BVH.queryRay(origin, direction, distance, [&](uint32_t first, uint32_t count) {
+        found |= RayKernel::intersect(m_Triangles, first, count, origin, direction, distance, triangle);
+        return distance;
+    });
+    return found;
+}
+
+CollisionMeshCache& CollisionMeshCache::get() {
+    static CollisionMeshCache instance;
+    return instance;
+}
+
+bool CollisionMeshCache::Entry::matches(const std::vector<float>& vertices, size_t vertexStride,
+    const std::vector<unsigned int>& otherIndices) const {
+    // Counts first, they settle almost every real collision
+    size_t vertexCount = vertices.size() >= 3 ? (vertices.size() - 3) / vertexStride + 1 : 0;
+    if (positions.size() != vertexCount * 3 || indices.size() != otherIndices.size()) {
+        return false;
+    }
+    if (!indices.empty() && std::memcmp(indices.data(), otherIndices.data(), indices.size() * sizeof(unsigned int)) != 0) {
+        return false;
+    }
+    for (size_t v = 0; v < vertexCount; v++) {
+        if (std::memcmp(&positions[v * 3], &vertices[v * vertexStride], 3 * sizeof(float)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<const CollisionMesh> CollisionMeshCache::find(uint64_t hash, const std::vector<float>& vertices,
+    size_t vertexStride, const std::vector<unsigned int>& indices) {
+    auto it = m_Meshes.find(hash);
+    if (it == m_Meshes.end()) {
+        return nullptr;
+    }
+    for (const Entry& entry : it->second) {
+        if (std::shared_ptr<const CollisionMesh> mesh = entry.mesh.lock()) {
+            if (entry.matches(vertices, vertexStride, indices)) {
+                return mesh;
+            }
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const CollisionMesh> CollisionMeshCache::acquire(const std::vector<float>& vertices, size_t vertexStride,
+    const std::vector<unsigned int>& indices) {
+    uint64_t hash = hashGeometry(vertices, vertexStride, indices);
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (std::shared_ptr<const CollisionMesh> mesh = find(hash, vertices, vertexStride, indices)) {
+            return mesh;
+        }
+    }
+
+    // Built outside the lock so other loaders are not blocked; a concurrent build of
+    // the same geometry just wastes work, the first one stored wins
+    auto mesh = std::make_shared<CollisionMesh>();
+    mesh->build(vertices, vertexStride, indices);
+
+    Entry entry;
+    entry.mesh = mesh;
+    for (size_t i = 0; i + 2 < vertices.size(); i += vertexStride) {
+        entry.positions.insert(entry.positions.end(), { vertices[i], vertices[i + 1], vertices[i + 2] });
+    }
+    entry.indices = indices;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (std::shared_ptr<const CollisionMesh> existing = find(hash, vertices, vertexStride, indices)) {
+        return existing;
+    }
+
+    // Expired entries go first, along with the geometry they kept
+    for (auto it = m_Meshes.begin(); it != m_Meshes.end();) {
+        std::vector<Entry>& entries = it->second;
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+            [](const Entry& e) { return e.mesh.expired(); }), entries.end());
+        it = entries.empty() ? m_Meshes.erase(it) : std::next(it);
+    }
+    m_Meshes[hash].push_back(std::move(entry));
+    return mesh;
+}
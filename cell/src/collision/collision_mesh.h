@@ -0,0 +1,105 @@
+#pragma once
+#include "bvh.h"
+#include "collision_heightfield.h"
+#include "collision_triangle.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Local-space triangles of one mesh with their bottom-level BVH, or a heightfield when the
+// mesh is a regular grid. Immutable once built, so every model instance of the same
+// geometry can share one.
+class CollisionMesh {
+private:
+    CollisionTriangleSoA m_Triangles;  // Stored in BVH leaf order, degenerate triangles dropped
+    BVH m_BVH;
+    // Set instead of m_Triangles and m_BVH for grid meshes
+    std::unique_ptr<CollisionHeightfield> m_Heightfield;
+    CollisionBounds m_Bounds;
+
+public:
+    // vertices holds vertexStride floats per vertex with the position first. Grid meshes
+    // become a heightfield unless allowHeightfield is false.
+    void build(const std::vector<float>& vertices, size_t vertexStride, const std::vector<unsigned int>& indices,
+        bool allowHeightfield = true);
+    // Authored terrain
+    void build(CollisionHeightfield heightfield);
+
+    // Calls visit(triangleIndex) for every triangle in a leaf or heightfield cell overlapping localBounds
+    template <typename Visitor>
+    void query(const CollisionBounds& localBounds, Visitor&& visit) const {
+        if (m_Heightfield) {
+            m_Heightfield->query(localBounds, [&](uint32_t index, const CollisionTriangle&) {
+                visit(index);
+            });
+            return;
+        }
+        m_BVH.queryLeaves(localBounds, [&](uint32_t first, uint32_t count) {
+            for (uint32_t i = first; i < first + count; i++) {
+                visit(i);
+            }
+        });
+    }
+
+    // Appends the triangle range of every leaf overlapping localBounds. Heightfield meshes have no leaves.
+    void collectLeaves(const CollisionBounds& localBounds, std::vector<TriangleRange>& ranges) const {
+        m_BVH.queryLeaves(localBounds, [&](uint32_t first, uint32_t count) {
+            ranges.push_back({ first, count });
+        });
+    }
+
+    // Closest hit of the local-space ray origin + t * direction with 0 <= t < distance; updates
+    // distance and triangle. BVH leaves are visited nearest first and tested with RayKernel.
+    bool raycast(const glm::vec3& origin, const glm::vec3& direction, float& distance, uint32_t& triangle) const;
+
+    // Works for both representations; triangle indices are the ones queries report
+    CollisionTriangle getTriangle(uint32_t index) const {
+        return m_Heightfield ? m_Heightfield->getTriangle(index) : m_Triangles.getTriangle(index);
+    }
+    size_t getTriangleCount() const { return m_Heightfield ? m_Heightfield->getTriangleCount() : m_Triangles.count; }
+
+    const CollisionTriangleSoA& getTriangles() const { return m_Triangles; }
+    const CollisionHeightfield* getHeightfield() const { return m_Heightfield.get(); }
+    const CollisionBounds& getBounds() const { return m_Bounds; }
+    const BVH& getBVH() const { return m_BVH; }
+    size_t getMemoryUsage() const {
+        return m_Triangles.getMemoryUsage() + m_BVH.getMemoryUsage() + (m_Heightfield ? m_Heightfield->getMemoryUsage() : 0);
+    }
+};
+
+// Shares CollisionMesh instances between models with identical geometry. Keyed by a hash
+// of the vertex positions and indices; a hit is only shared once the stored geometry compares
+// equal, so colliding hashes get separate meshes. Entries are weak, like TextureCache.
+class CollisionMeshCache {
+private:
+    struct Entry {
+        std::weak_ptr<const CollisionMesh> mesh;
+        // What the mesh was built from, positions only
+        std::vector<float> positions;
+        std::vector<unsigned int> indices;
+
+        bool matches(const std::vector<float>& vertices, size_t vertexStride, const std::vector<unsigned int>& otherIndices) const;
+    };
+
+    std::mutex m_Mutex;
+    std::unordered_map<uint64_t, std::vector<Entry>> m_Meshes;
+
+    // Live mesh of an entry under hash whose geometry matches; caller holds m_Mutex
+    std::shared_ptr<const CollisionMesh> find(uint64_t hash, const std::vector<float>& vertices, size_t vertexStride,
+        const std::vector<unsigned int>& indices);
+
+    CollisionMeshCache() = default;
+
+public:
+    static CollisionMeshCache& get();
+
+    CollisionMeshCache(const CollisionMeshCache&) = delete;
+    CollisionMeshCache& operator=(const CollisionMeshCache&) = delete;
+
+    // Safe to call from loader threads; builds the BVH on first use
+    std::shared_ptr<const CollisionMesh> acquire(const std::vector<float>& vertices, size_t vertexStride,
+        const std::vector<unsigned int>& indices);
+};
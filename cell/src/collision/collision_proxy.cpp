@@ -0,0 +1,127 @@
+#include "collision_proxy.h"
+#include "collision_heightfield.h"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+    // Cell coordinates are packed 21 bits per axis into one key
+    constexpr uint64_t CELL_AXIS_MASK = (1ull << 21) - 1;
+
+    using TriangleKey = std::array<unsigned int, 3>;
+
+    // FNV-1a over the three cluster indices
+    struct TriangleKeyHash {
+        size_t operator()(const TriangleKey& key) const {
+            uint64_t hash = 14695981039346656037ull;
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(key.data());
+            for (size_t i = 0; i < sizeof(TriangleKey); i++) {
+                hash ^= bytes[i];
+                hash *= 1099511628211ull;
+            }
+            return static_cast<size_t>(hash);
+        }
+    };
+}
+
+bool CollisionProxy::isCollisionShapeName(const std::string& name) {
+    // "_col" as a whole word, so "_color" does not count
+    for (size_t position = name.find("_col"); position != std::string::npos; position = name.find("_col", position + 1)) {
+        size_t end = position + 4;
+        if (end == name.size() || name[end] == '_' || name[end] == '.') {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CollisionProxy::simplify(const std::vector<float>& vertices, size_t vertexStride, const std::vector<unsigned int>& indices,
+    float cellSize, std::vector<float>& proxyVertices, std::vector<unsigned int>& proxyIndices) {
+    proxyVertices.clear();
+    proxyIndices.clear();
+
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount <= MIN_SIMPLIFY_TRIANGLES || cellSize <= 0.0f) {
+        return false;
+    }
+
+    // Clustering would break the grid, and the heightfield is cheaper than any proxy
+    {
+        CollisionHeightfield heightfield;
+        if (heightfield.detect(vertices, vertexStride, indices)) {
+            return false;
+        }
+    }
+
+    size_t vertexCount = vertices.size() / vertexStride;
+    auto position = [&](size_t vertex) {
+        return glm::vec3(vertices[vertex * vertexStride], vertices[vertex * vertexStride + 1], vertices[vertex * vertexStride + 2]);
+    };
+
+    glm::vec3 boundsMin(std::numeric_limits<float>::max());
+    for (size_t v = 0; v < vertexCount; v++) {
+        boundsMin = glm::min(boundsMin, position(v));
+    }
+
+    // Clusters numbered in first-seen order, each accumulating the positions that fall into it
+    std::unordered_map<uint64_t, unsigned int> clusters;
+    std::vector<unsigned int> vertexClusters(vertexCount);
+    std::vector<glm::vec3> clusterSums;
+    std::vector<unsigned int> clusterCounts;
+    for (size_t v = 0; v < vertexCount; v++) {
+        glm::vec3 p = position(v);
+        glm::vec3 cell = glm::floor((p - boundsMin) / cellSize);
+        uint64_t key = 0;
+        for (int axis = 0; axis < 3; axis++) {
+            key = (key << 21) | std::min(static_cast<uint64_t>(cell[axis]), CELL_AXIS_MASK);
+        }
+
+        auto [it, inserted] = clusters.try_emplace(key, static_cast<unsigned int>(clusterSums.size()));
+        if (inserted) {
+            clusterSums.push_back(glm::vec3(0.0f));
+            clusterCounts.push_back(0);
+        }
+        clusterSums[it->second] += p;
+        clusterCounts[it->second]++;
+        vertexClusters[v] = it->second;
+    }
+
+    // Triangles between clusters; collapsed ones and repeats of the same face are dropped
+    std::unordered_set<TriangleKey, TriangleKeyHash> seenTriangles;
+    std::vector<unsigned int> clusterIndices;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        TriangleKey triangle = { vertexClusters[indices[i]], vertexClusters[indices[i + 1]], vertexClusters[indices[i + 2]] };
+        if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[0] == triangle[2]) {
+            continue;
+        }
+
+        // Same winding, whichever corner it starts from; the opposite face of a thin wall is kept
+        TriangleKey key = triangle;
+        std::rotate(key.begin(), std::min_element(key.begin(), key.end()), key.end());
+        if (!seenTriangles.insert(key).second) {
+            continue;
+        }
+        clusterIndices.insert(clusterIndices.end(), triangle.begin(), triangle.end());
+    }
+
+    if (clusterIndices.size() / 3 > triangleCount * MAX_KEPT_FRACTION) {
+        return false;
+    }
+
+    // Emit only the clusters the kept triangles use
+    std::vector<unsigned int> remap(clusterSums.size(), std::numeric_limits<unsigned int>::max());
+    proxyIndices.reserve(clusterIndices.size());
+    for (unsigned int cluster : clusterIndices) {
+        if (remap[cluster] == std::numeric_limits<unsigned int>::max()) {
+            remap[cluster] = static_cast<unsigned int>(proxyVertices.size() / 3);
+            glm::vec3 average = clusterSums[cluster] / static_cast<float>(clusterCounts[cluster]);
+            proxyVertices.insert(proxyVertices.end(), { average.x, average.y, average.z });
+        }
+        proxyIndices.push_back(remap[cluster]);
+    }
+    return true;
+}
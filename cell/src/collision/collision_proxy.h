@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Simplified stand-in geometry that collision tests instead of the render mesh, cooked once
+// at import. Either authored in the .obj as shapes named with "_col", or generated here by
+// vertex clustering, which merges detail smaller than the player into flat faces.
+class CollisionProxy {
+public:
+    // Side of a clustering cell in model units, a quarter of the player's half extent
+    static constexpr float CLUSTER_SIZE = 0.1f;
+    // Meshes this small are cheap enough to collide with as they are
+    static constexpr size_t MIN_SIMPLIFY_TRIANGLES = 256;
+    // Proxies that keep more of the triangles than this are not worth storing
+    static constexpr float MAX_KEPT_FRACTION = 0.75f;
+
+    // "house_col", "house_col_Cube.001"; such shapes are collision-only and never rendered
+    static bool isCollisionShapeName(const std::string& name);
+
+    // Vertex clustering: positions are snapped to cells of cellSize, each cell's vertices merged
+    // into their average, and triangles that collapse or repeat dropped. Writes tightly packed
+    // positions (stride 3). Returns false, leaving the outputs empty, when the render mesh should
+    // be used instead: it is already small, it is a regular grid the heightfield handles, or
+    // clustering saves too little.
+    static bool simplify(const std::vector<float>& vertices, size_t vertexStride, const std::vector<unsigned int>& indices,
+        float cellSize, std::vector<float>& proxyVertices, std::vector<unsigned int>& proxyIndices);
+};
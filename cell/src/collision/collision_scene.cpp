@@ -0,0 +1,69 @@
+#include "collision_scene.h"
+
+void CollisionScene::setInstance(uint64_t id, std::shared_ptr<const CollisionMesh> mesh, const glm::mat4& transform) {
+    auto [it, inserted] = m_InstanceSlots.try_emplace(id, static_cast<uint32_t>(m_Instances.size()));
+    if (inserted) {
+        m_Instances.emplace_back();
+        m_NeedsRebuild = true;
+    }
+    else {
+        m_NeedsRefit = true;
+    }
+
+    CollisionInstance& instance = m_Instances[it->second];
+    instance.id = id;
+    instance.mesh = std::move(mesh);
+    instance.transform = transform;
+    instance.inverseTransform = glm::inverse(transform);
+    instance.isTranslationOnly = glm::mat3(transform) == glm::mat3(1.0f) &&
+        transform[0][3] == 0.0f && transform[1][3] == 0.0f && transform[2][3] == 0.0f && transform[3][3] == 1.0f;
+    instance.translation = glm::vec3(transform[3]);
+    instance.revision = ++m_Revision;
+    instance.worldBounds = instance.mesh->getBounds().isEmpty()
+        ? CollisionBounds()
+        : transformBounds(instance.mesh->getBounds(), transform);
+}
+
+void CollisionScene::removeInstance(uint64_t id) {
+    auto it = m_InstanceSlots.find(id);
+    if (it == m_InstanceSlots.end()) {
+        return;
+    }
+
+    // Swap-remove, then fix the slot of the instance that moved
+    uint32_t slot = it->second;
+    m_InstanceSlots.erase(it);
+    if (slot != m_Instances.size() - 1) {
+        m_Instances[slot] = std::move(m_Instances.back());
+        m_InstanceSlots[m_Instances[slot].id] = slot;
+    }
+    m_Instances.pop_back();
+    m_NeedsRebuild = true;
+    m_Revision++;
+}
+
+const CollisionInstance* CollisionScene::findInstance(uint64_t id) const {
+    auto it = m_InstanceSlots.find(id);
+    return it != m_InstanceSlots.end() ? &m_Instances[it->second] : nullptr;
+}
+
+void CollisionScene::update() {
+    if (!m_NeedsRebuild && !m_NeedsRefit) {
+        return;
+    }
+
+    std::vector<CollisionBounds> instanceBounds(m_Instances.size());
+    for (size_t i = 0; i < m_Instances.size(); i++) {
+        instanceBounds[i] = m_Instances[i].worldBounds;
+    }
+
+    if (m_NeedsRebuild) {
+        m_TopLevel.build(instanceBounds);
+    }
+    else {
+        m_TopLevel.refit(instanceBounds);
+    }
+
+    m_NeedsRebuild = false;
+    m_NeedsRefit = false;
+}
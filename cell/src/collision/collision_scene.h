@@ -0,0 +1,123 @@
+#pragma once
+#include "bvh.h"
+#include "collision_mesh.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// One placement of a shared CollisionMesh in the world
+struct CollisionInstance {
+    uint64_t id = 0;  // Caller-chosen, e.g. Model::getID
+    std::shared_ptr<const CollisionMesh> mesh;
+    glm::mat4 transform = glm::mat4(1.0f);
+    glm::mat4 inverseTransform = glm::mat4(1.0f);
+    // No rotation or scale: queries just shift into local space, and the triangle data
+    // precomputed for the axis-aligned tests stays valid
+    bool isTranslationOnly = true;
+    glm::vec3 translation = glm::vec3(0.0f);
+    CollisionBounds worldBounds;
+    // Scene revision of the last setInstance; anything derived from the transform is stale once it changes
+    uint64_t revision = 0;
+};
+
+// Top level of the two-level collision structure: a small BVH over instance world
+// bounds. Moving an instance refits it; adding or removing one rebuilds it, which
+// is cheap because it holds one leaf entry per instance, never per triangle.
+class CollisionScene {
+private:
+    std::vector<CollisionInstance> m_Instances;
+    std::unordered_map<uint64_t, uint32_t> m_InstanceSlots;  // id -> index in m_Instances
+    BVH m_TopLevel;
+    bool m_NeedsRebuild = false;
+    bool m_NeedsRefit = false;
+    uint64_t m_Revision = 0;  // Bumped by every set or remove
+
+public:
+    // Adds the instance or replaces its mesh and transform
+    void setInstance(uint64_t id, std::shared_ptr<const CollisionMesh> mesh, const glm::mat4& transform);
+    void removeInstance(uint64_t id);
+    bool hasInstance(uint64_t id) const { return m_InstanceSlots.count(id) != 0; }
+    const CollisionInstance* findInstance(uint64_t id) const;
+    uint64_t getRevision() const { return m_Revision; }
+
+    // Brings the top-level tree up to date; call after a batch of set/remove
+    void update();
+
+    // Calls visit(instance, localBounds) for every instance whose world bounds overlap
+    // worldBounds; localBounds is worldBounds moved into the instance's mesh space
+    template <typename Visitor>
+    void queryInstances(const CollisionBounds& worldBounds, Visitor&& visit) const;
+
+    // Calls visit(instance, triangleIndex) for every candidate triangle near worldBounds.
+    // Triangles are in the instance's local space.
+    template <typename Visitor>
+    void query(const CollisionBounds& worldBounds, Visitor&& visit) const;
+
+    // Calls visit(instance, localOrigin, localDirection) for every instance the ray origin + t * direction
+    // reaches within maxDistance, nearest subtrees first. The local ray is the same line in mesh space
+    // with the same parameter t, so distances need no conversion. visit returns the distance still
+    // worth searching.
+    template <typename Visitor>
+    void queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Visitor&& visit) const;
+
+    const std::vector<CollisionInstance>& getInstances() const { return m_Instances; }
+};
+
+template <typename Visitor>
+void CollisionScene::queryInstances(const CollisionBounds& worldBounds, Visitor&& visit) const {
+    m_TopLevel.query(worldBounds, [&](uint32_t instanceIndex) {
+        const CollisionInstance& instance = m_Instances[instanceIndex];
+        if (!instance.worldBounds.overlaps(worldBounds)) {
+            return;
+        }
+
+        // The bottom level is searched in the mesh's own space
+        CollisionBounds localBounds = worldBounds;
+        if (instance.isTranslationOnly) {
+            localBounds.min -= instance.translation;
+            localBounds.max -= instance.translation;
+        }
+        else {
+            localBounds = transformBounds(worldBounds, instance.inverseTransform);
+        }
+
+        visit(instance, localBounds);
+    });
+}
+
+template <typename Visitor>
+void CollisionScene::query(const CollisionBounds& worldBounds, Visitor&& visit) const {
+    queryInstances(worldBounds, [&](const CollisionInstance& instance, const CollisionBounds& localBounds) {
+        instance.mesh->query(localBounds, [&](uint32_t triangleIndex) {
+            visit(instance, triangleIndex);
+        });
+    });
+}
+
+template <typename Visitor>
+void CollisionScene::queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Visitor&& visit) const {
+    glm::vec3 inverseDirection = getSafeInverseDirection(direction);
+    const std::vector<uint32_t>& instanceIndices = m_TopLevel.getPrimitiveIndices();
+
+    m_TopLevel.queryRay(origin, direction, maxDistance, [&](uint32_t first, uint32_t count) {
+        for (uint32_t i = first; i < first + count; i++) {
+            const CollisionInstance& instance = m_Instances[instanceIndices[i]];
+            if (intersectRayBounds(origin, inverseDirection, maxDistance, instance.worldBounds.min, instance.worldBounds.max) > maxDistance) {
+                continue;
+            }
+
+            if (instance.isTranslationOnly) {
+                maxDistance = visit(instance, origin - instance.translation, direction);
+            }
+            else {
+                // Not renormalized: an affine map keeps t the same along the line
+                glm::vec3 localOrigin = glm::vec3(instance.inverseTransform * glm::vec4(origin, 1.0f));
+                glm::vec3 localDirection = glm::mat3(instance.inverseTransform) * direction;
+                maxDistance = visit(instance, localOrigin, localDirection);
+            }
+        }
+        return maxDistance;
+    });
+}
@@ -0,0 +1,131 @@
+#include "collision_triangle.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Far outside any level, so padding lanes are always separated
+    constexpr float PADDING_COORDINATE = 1e30f;
+
+    // Matches the old glm::length(axis) > 0.0001 threshold for cross axes
+    constexpr float MIN_AXIS_LENGTH_SQUARED = 1e-8f;
+}
+
+bool CollisionTriangleSoA::isDegenerate(const CollisionTriangle& triangle) {
+    glm::vec3 doubleArea = glm::cross(triangle.v1 - triangle.v0, triangle.v2 - triangle.v0);
+    return !(glm::dot(doubleArea, doubleArea) >= MIN_DOUBLE_AREA_SQUARED);
+}
+
+void CollisionTriangleSoA::assign(const std::vector<CollisionTriangle>& triangles, std::vector<uint32_t>* keptIndices) {
+    std::vector<float>* arrays[] = {
+        &v0x, &v0y, &v0z, &e1x, &e1y, &e1z, &e2x, &e2y, &e2z,
+        &nx, &ny, &nz, &nd, &minX, &minY, &minZ, &maxX, &maxY, &maxZ
+    };
+
+    // Counted first so each array is sized once
+    count = 0;
+    for (const CollisionTriangle& triangle : triangles) {
+        count += isDegenerate(triangle) ? 0 : 1;
+    }
+
+    for (std::vector<float>* array : arrays) {
+        array->assign(count + PADDING, PADDING_COORDINATE);
+    }
+    for (int axis = 0; axis < CROSS_AXIS_COUNT; axis++) {
+        crossA[axis].assign(count + PADDING, 0.0f);
+        crossB[axis].assign(count + PADDING, 0.0f);
+        crossMin[axis].assign(count + PADDING, PADDING_COORDINATE);
+        crossMax[axis].assign(count + PADDING, PADDING_COORDINATE);
+    }
+    if (keptIndices) {
+        keptIndices->clear();
+        keptIndices->reserve(count);
+    }
+
+    size_t slot = 0;
+    for (size_t i = 0; i < triangles.size(); i++) {
+        const CollisionTriangle& triangle = triangles[i];
+        if (isDegenerate(triangle)) {
+            continue;
+        }
+        if (keptIndices) {
+            keptIndices->push_back(static_cast<uint32_t>(i));
+        }
+
+        const glm::vec3 vertices[3] = { triangle.v0, triangle.v1, triangle.v2 };
+        glm::vec3 edge1 = triangle.v1 - triangle.v0;
+        glm::vec3 edge2 = triangle.v2 - triangle.v0;
+        glm::vec3 normal = glm::normalize(glm::cross(edge1, edge2));
+        glm::vec3 boundsMin = glm::min(glm::min(vertices[0], vertices[1]), vertices[2]);
+        glm::vec3 boundsMax = glm::max(glm::max(vertices[0], vertices[1]), vertices[2]);
+
+        v0x[slot] = triangle.v0.x; v0y[slot] = triangle.v0.y; v0z[slot] = triangle.v0.z;
+        e1x[slot] = edge1.x; e1y[slot] = edge1.y; e1z[slot] = edge1.z;
+        e2x[slot] = edge2.x; e2y[slot] = edge2.y; e2z[slot] = edge2.z;
+        nx[slot] = normal.x; ny[slot] = normal.y; nz[slot] = normal.z;
+        nd[slot] = glm::dot(normal, triangle.v0);
+        minX[slot] = boundsMin.x; minY[slot] = boundsMin.y; minZ[slot] = boundsMin.z;
+        maxX[slot] = boundsMax.x; maxY[slot] = boundsMax.y; maxZ[slot] = boundsMax.z;
+
+        const glm::vec3 edges[3] = { triangle.v1 - triangle.v0, triangle.v2 - triangle.v1, triangle.v0 - triangle.v2 };
+        for (int edge = 0; edge < 3; edge++) {
+            const glm::vec3& e = edges[edge];
+            // x cross e = (0, -e.z, e.y), y cross e = (e.z, 0, -e.x), z cross e = (-e.y, e.x, 0)
+            const glm::vec3 axes[3] = {
+                glm::vec3(0.0f, -e.z, e.y),
+                glm::vec3(e.z, 0.0f, -e.x),
+                glm::vec3(-e.y, e.x, 0.0f)
+            };
+
+            for (int worldAxis = 0; worldAxis < 3; worldAxis++) {
+                int index = edge * 3 + worldAxis;
+                glm::vec3 axis = axes[worldAxis];
+                float lengthSquared = glm::dot(axis, axis);
+
+                if (lengthSquared <= MIN_AXIS_LENGTH_SQUARED) {
+                    crossMin[index][slot] = 0.0f;
+                    crossMax[index][slot] = 0.0f;
+                    continue;
+                }
+
+                axis /= std::sqrt(lengthSquared);
+                int a = worldAxis == 0 ? 1 : 0;
+                int b = worldAxis == 2 ? 1 : 2;
+                crossA[index][slot] = axis[a];
+                crossB[index][slot] = axis[b];
+
+                float p0 = glm::dot(axis, vertices[0]);
+                float p1 = glm::dot(axis, vertices[1]);
+                float p2 = glm::dot(axis, vertices[2]);
+                crossMin[index][slot] = std::min({ p0, p1, p2 });
+                crossMax[index][slot] = std::max({ p0, p1, p2 });
+            }
+        }
+
+        slot++;
+    }
+}
+
+CollisionTriangle CollisionTriangleSoA::getTriangle(size_t index) const {
+    CollisionTriangle triangle;
+    triangle.v0 = glm::vec3(v0x[index], v0y[index], v0z[index]);
+    triangle.v1 = triangle.v0 + glm::vec3(e1x[index], e1y[index], e1z[index]);
+    triangle.v2 = triangle.v0 + glm::vec3(e2x[index], e2y[index], e2z[index]);
+    triangle.normal = glm::vec3(nx[index], ny[index], nz[index]);
+    return triangle;
+}
+
+size_t CollisionTriangleSoA::getMemoryUsage() const {
+    const std::vector<float>* arrays[] = {
+        &v0x, &v0y, &v0z, &e1x, &e1y, &e1z, &e2x, &e2y, &e2z,
+        &nx, &ny, &nz, &nd, &minX, &minY, &minZ, &maxX, &maxY, &maxZ
+    };
+
+    size_t floats = 0;
+    for (const std::vector<float>* array : arrays) {
+        floats += array->capacity();
+    }
+    for (int axis = 0; axis < CROSS_AXIS_COUNT; axis++) {
+        floats += crossA[axis].capacity() + crossB[axis].capacity() + crossMin[axis].capacity() + crossMax[axis].capacity();
+    }
+    return floats * sizeof(float);
+}
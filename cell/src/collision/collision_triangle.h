@@ -0,0 +1,58 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Represents a triangle for collision detection
+struct CollisionTriangle {
+    glm::vec3 v0, v1, v2;  // Vertices
+    glm::vec3 normal;      // Triangle normal
+};
+
+// Triangles as structure-of-arrays with everything the separating axis test needs
+// precomputed at build time, so a query only has to project its box. SIMD kernels
+// load one field of 4 or 8 triangles with a single instruction; every array carries
+// PADDING extra floats so full-width loads at the tail stay in bounds.
+struct CollisionTriangleSoA {
+    static constexpr size_t PADDING = 8;
+    // Triangle edges (v1 - v0, v2 - v1, v0 - v2) crossed with the x, y and z axes
+    static constexpr int CROSS_AXIS_COUNT = 9;
+    // Triangles with a smaller doubled area than this are dropped as degenerate
+    static constexpr float MIN_DOUBLE_AREA_SQUARED = 1e-12f;
+
+    // Vertex 0 and the two edges leaving it
+    std::vector<float> v0x, v0y, v0z;
+    std::vector<float> e1x, e1y, e1z;  // v1 - v0
+    std::vector<float> e2x, e2y, e2z;  // v2 - v0
+
+    // Unit normal and plane offset dot(normal, v0)
+    std::vector<float> nx, ny, nz, nd;
+
+    // Extents on the box face axes
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+
+    // Cross axis i = edge (i / 3) crossed with world axis (i % 3), normalized. World axis k
+    // contributes nothing to its cross product, so only the other two components are kept,
+    // in x, y, z order: crossA/crossB. Near-parallel axes are stored as zero, which never
+    // separates. crossMin/crossMax are the triangle's extent along each axis.
+    std::vector<float> crossA[CROSS_AXIS_COUNT], crossB[CROSS_AXIS_COUNT];
+    std::vector<float> crossMin[CROSS_AXIS_COUNT], crossMax[CROSS_AXIS_COUNT];
+
+    size_t count = 0;
+
+    // Degenerate triangles are skipped; keptIndices, if given, receives the input index of each kept one
+    void assign(const std::vector<CollisionTriangle>& triangles, std::vector<uint32_t>* keptIndices = nullptr);
+    void clear() { assign({}); }
+
+    CollisionTriangle getTriangle(size_t index) const;
+    // Bytes held by all arrays, padding included
+    size_t getMemoryUsage() const;
+    static bool isDegenerate(const CollisionTriangle& triangle);
+};
+
+// A contiguous run of triangles, typically one BVH leaf
+struct TriangleRange {
+    uint32_t first;
+    uint32_t count;
+};
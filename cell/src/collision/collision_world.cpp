@@ -0,0 +1,425 @@
+#include "collision_world.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void CollisionWorld::setBody(uint64_t id, const glm::vec3& center, const glm::vec3& halfExtents) {
+    auto [it, inserted] = m_BodySlots.try_emplace(id, static_cast<uint32_t>(m_Bodies.size()));
+    if (inserted) {
+        m_Bodies.emplace_back();
+        m_Bodies.back().id = id;
+    }
+
+    // Contacts only carry over if the body is where the last step left it
+    CollisionBody& body = m_Bodies[it->second];
+    if (body.center != center || body.halfExtents != halfExtents) {
+        body.manifoldCount = 0;
+        body.needsOverlapCheck = true;
+    }
+    body.center = center;
+    body.halfExtents = halfExtents;
+}
+
+void CollisionWorld::removeBody(uint64_t id) {
+    auto it = m_BodySlots.find(id);
+    if (it == m_BodySlots.end()) {
+        return;
+    }
+
+    // Swap-remove keeps the body array dense
+    uint32_t slot = it->second;
+    m_BodySlots.erase(it);
+    if (slot != m_Bodies.size() - 1) {
+        m_Bodies[slot] = std::move(m_Bodies.back());
+        m_BodySlots[m_Bodies[slot].id] = slot;
+    }
+    m_Bodies.pop_back();
+}
+
+void CollisionWorld::moveBody(uint64_t id, const glm::vec3& displacement) {
+    auto it = m_BodySlots.find(id);
+    if (it != m_BodySlots.end()) {
+        m_Bodies[it->second].displacement += displacement;
+    }
+}
+
+const CollisionBody* CollisionWorld::getBody(uint64_t id) const {
+    auto it = m_BodySlots.find(id);
+    return it != m_BodySlots.end() ? &m_Bodies[it->second] : nullptr;
+}
+
+CollisionWorld::CollisionWorld(ThreadPool& pool)
+    : m_Pool(pool)
+{
+}
+
+bool CollisionWorld::getGroundHeight(float x, float z, float maxHeight, float& height) const {
+    CollisionBounds column;
+    column.min = glm::vec3(x, -std::numeric_limits<float>::max(), z);
+    column.max = glm::vec3(x, maxHeight, z);
+
+    bool found = false;
+    m_Scene.queryInstances(column, [&](const CollisionInstance& instance, const CollisionBounds&) {
+        const CollisionHeightfield* heightfield = instance.mesh->getHeightfield();
+        float localHeight;
+        if (!heightfield || !instance.isTranslationOnly ||
+            !heightfield->getHeight(x - instance.translation.x, z - instance.translation.z, localHeight)) {
+            return;
+        }
+
+        float worldHeight = localHeight + instance.translation.y;
+        if (worldHeight <= maxHeight && (!found || worldHeight > height)) {
+            height = worldHeight;
+            found = true;
+        }
+    });
+    return found;
+}
+
+CollisionRay CollisionRay::segment(const glm::vec3& start, const glm::vec3& end) {
+    CollisionRay ray;
+    ray.origin = start;
+    ray.maxDistance = glm::length(end - start);
+    if (ray.maxDistance > 0.0f) {
+        ray.direction = (end - start) / ray.maxDistance;
+    }
+    return ray;
+}
+
+bool CollisionWorld::raycast(const CollisionRay& ray, RaycastHit& hit) const {
+    hit = RaycastHit();
+    float distance = ray.maxDistance;
+    const CollisionInstance* hitInstance = nullptr;
+    m_Scene.queryRay(ray.origin, ray.direction, ray.maxDistance,
+        [&](const CollisionInstance& instance, const glm::vec3& localOrigin, const glm::vec3& localDirection) {
+            if (instance.mesh->raycast(localOrigin, localDirection, distance, hit.triangle)) {
+                hitInstance = &instance;
+            }
+            return distance;
+        });
+    if (!hitInstance) {
+        return false;
+    }
+
+    // Normals of rotated or scaled instances go through the inverse-transpose
+    glm::vec3 normal = hitInstance->mesh->getTriangle(hit.triangle).normal;
+    if (!hitInstance->isTranslationOnly) {
+        normal = glm::normalize(glm::transpose(glm::mat3(hitInstance->inverseTransform)) * normal);
+    }
+
+    hit.hit = true;
+    hit.distance = distance;
+    hit.point = ray.origin + ray.direction * distance;
+    hit.normal = glm::dot(normal, ray.direction) > 0.0f ? -normal : normal;
+    hit.instanceID = hitInstance->id;
+    return true;
+}
+
+void CollisionWorld::raycast(const std::vector<CollisionRay>& rays, std::vector<RaycastHit>& hits) const {
+    hits.resize(rays.size());
+    m_Pool.parallelFor(rays.size(), MIN_RAYS_PER_JOB, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; i++) {
+            raycast(rays[i], hits[i]);
+        }
+    });
+}
+
+void CollisionWorld::step() {
+    size_t jobCount = m_Pool.getChunkCount(m_Bodies.size(), MIN_BODIES_PER_JOB);
+    if (m_Scratch.size() < jobCount) {
+        m_Scratch.resize(jobCount);
+    }
+
+    // Each job owns a contiguous run of bodies and one scratch slot
+    m_Pool.parallelFor(m_Bodies.size(), MIN_BODIES_PER_JOB, [this](size_t begin, size_t end, size_t job) {
+        JobScratch& scratch = m_Scratch[job];
+        scratch.contacts.clear();
+        scratch.firstBody = begin;
+        scratch.endBody = end;
+        for (size_t i = begin; i < end; i++) {
+            stepBody(m_Bodies[i], scratch);
+        }
+    });
+
+    // Jobs cover the bodies in order, so appending their buffers in job order keeps contacts in body order
+    m_Contacts.clear();
+    for (size_t job = 0; job < jobCount; job++) {
+        const JobScratch& scratch = m_Scratch[job];
+        uint32_t offset = static_cast<uint32_t>(m_Contacts.size());
+        for (size_t i = scratch.firstBody; i < scratch.endBody; i++) {
+            m_Bodies[i].firstContact += offset;
+        }
+        m_Contacts.insert(m_Contacts.end(), scratch.contacts.begin(), scratch.contacts.end());
+    }
+}
+
+void CollisionWorld::stepBody(CollisionBody& body, JobScratch& scratch) const {
+    glm::vec3 displacement = body.displacement;
+    body.displacement = glm::vec3(0.0f);
+
+    // Surfaces the body already rests on stop the move up front, so they are not swept into again
+    revalidateManifold(body);
+    clipAgainstManifold(body, displacement);
+    if (glm::dot(displacement, displacement) > 0.0f) {
+        moveAndSlide(body, displacement, scratch);
+        body.needsOverlapCheck = true;
+    }
+
+    // Catches what sweeps skip: bodies placed inside geometry, or geometry moved into a body
+    if (body.needsOverlapCheck || body.checkedSceneRevision != m_Scene.getRevision()) {
+        body.needsOverlapCheck = false;
+        body.checkedSceneRevision = m_Scene.getRevision();
+        resolveOverlaps(body, scratch);
+    }
+
+    // Drop what the move left behind
+    revalidateManifold(body);
+    body.groundState = classifyGround(body);
+
+    body.firstContact = static_cast<uint32_t>(scratch.contacts.size());
+    for (uint32_t i = 0; i < body.manifoldCount; i++) {
+        const ManifoldContact& contact = body.manifold[i];
+        scratch.contacts.push_back({ contact.instanceID, contact.triangle, contact.normal });
+    }
+    body.contactCount = body.manifoldCount;
+}
+
+void CollisionWorld::clipAgainstManifold(const CollisionBody& body, glm::vec3& displacement) const {
+    for (uint32_t i = 0; i < body.manifoldCount; i++) {
+        const glm::vec3& normal = body.manifold[i].normal;
+        displacement -= normal * std::min(glm::dot(displacement, normal), 0.0f);
+    }
+}
+
+void CollisionWorld::revalidateManifold(CollisionBody& body) const {
+    CollisionBounds bodyBounds;
+    bodyBounds.min = body.center - body.halfExtents - glm::vec3(CONTACT_MARGIN);
+    bodyBounds.max = body.center + body.halfExtents + glm::vec3(CONTACT_MARGIN);
+
+    // One plane distance and one box test per contact instead of the full 13 axes
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < body.manifoldCount; i++) {
+        const ManifoldContact& contact = body.manifold[i];
+        const CollisionInstance* instance = m_Scene.findInstance(contact.instanceID);
+        if (!instance || instance->revision != contact.instanceRevision || !contact.bounds.overlaps(bodyBounds)) {
+            continue;
+        }
+
+        // Penetrating contacts are dropped too and left to the overlap pass
+        float radius = glm::dot(body.halfExtents, glm::abs(contact.normal));
+        float gap = glm::dot(contact.normal, body.center) - radius - contact.planeOffset;
+        if (gap < 0.0f) {
+            body.needsOverlapCheck = true;
+            continue;
+        }
+        if (gap > CONTACT_MARGIN) {
+            continue;
+        }
+
+        body.manifold[kept++] = contact;
+    }
+    body.manifoldCount = kept;
+}
+
+void CollisionWorld::addToManifold(CollisionBody& body, const CollisionInstance& instance, uint32_t triangle,
+    const glm::vec3& normal) const {
+    if (isInManifold(body, instance.id, triangle)) {
+        return;
+    }
+
+    // Full: the oldest contact makes room
+    if (body.manifoldCount == CollisionBody::MAX_MANIFOLD_CONTACTS) {
+        std::move(body.manifold + 1, body.manifold + body.manifoldCount, body.manifold);
+        body.manifoldCount--;
+    }
+
+    CollisionTriangle local = instance.mesh->getTriangle(triangle);
+    glm::vec3 vertices[3] = { local.v0, local.v1, local.v2 };
+
+    ManifoldContact& contact = body.manifold[body.manifoldCount++];
+    contact.instanceID = instance.id;
+    contact.triangle = triangle;
+    contact.instanceRevision = instance.revision;
+    contact.normal = normal;
+    contact.planeOffset = -std::numeric_limits<float>::max();
+    contact.bounds = CollisionBounds();
+    for (const glm::vec3& vertex : vertices) {
+        glm::vec3 world = instance.isTranslationOnly
+            ? vertex + instance.translation
+            : glm::vec3(instance.transform * glm::vec4(vertex, 1.0f));
+        contact.planeOffset = std::max(contact.planeOffset, glm::dot(normal, world));
+        contact.bounds.grow(world);
+    }
+}
+
+bool CollisionWorld::isInManifold(const CollisionBody& body, uint64_t instanceID, uint32_t triangle) {
+    for (uint32_t i = 0; i < body.manifoldCount; i++) {
+        if (body.manifold[i].instanceID == instanceID && body.manifold[i].triangle == triangle) {
+            return true;
+        }
+    }
+    return false;
+}
+
+GroundState CollisionWorld::classifyGround(const CollisionBody& body) {
+    GroundState state = GroundState::Airborne;
+    for (uint32_t i = 0; i < body.manifoldCount; i++) {
+        float up = body.manifold[i].normal.y;
+        if (up >= MIN_GROUND_NORMAL_Y) {
+            return GroundState::Grounded;
+        }
+        if (up > 0.0f) {
+            state = GroundState::Sliding;
+        }
+    }
+    return state;
+}
+
+void CollisionWorld::moveAndSlide(CollisionBody& body, glm::vec3 displacement, JobScratch& scratch) const {
+    for (int i = 0; i < MAX_SLIDE_ITERATIONS && glm::dot(displacement, displacement) > 0.0f; i++) {
+        SweepHit hit;
+        const CollisionInstance* hitInstance = nullptr;
+        if (!sweep(body.center, body.halfExtents, displacement, scratch, hit, hitInstance)) {
+            body.center += displacement;
+            return;
+        }
+
+        // Advance to the contact, then step back off the surface by the skin width
+        body.center += displacement * hit.time + hit.normal * SKIN_WIDTH;
+        addToManifold(body, *hitInstance, hit.triangle, hit.normal);
+
+        // Slide: the rest of the move loses its component into every surface touched so far
+        displacement *= 1.0f - hit.time;
+        clipAgainstManifold(body, displacement);
+    }
+}
+
+void CollisionWorld::resolveOverlaps(CollisionBody& body, JobScratch& scratch) const {
+    CollisionBounds bounds;
+    bounds.min = body.center - body.halfExtents;
+    bounds.max = body.center + body.halfExtents;
+
+    // Only triangles of overlapping instances and leaves are tested
+    m_Scene.queryInstances(bounds, [&](const CollisionInstance& instance, const CollisionBounds& localBounds) {
+        glm::vec3 spaceOffset;
+        const CollisionTriangleSoA* triangles = collectCandidates(instance, localBounds, scratch, spaceOffset);
+        if (!triangles) {
+            return;
+        }
+
+        scratch.hits.clear();
+        SATKernel::overlapBox(*triangles, scratch.candidateRanges, body.center - spaceOffset, body.halfExtents, scratch.hits);
+
+        for (uint32_t hit : scratch.hits) {
+            uint32_t meshTriangle = getMeshTriangle(scratch, hit);
+            if (isInManifold(body, instance.id, meshTriangle)) {
+                continue;
+            }
+
+            // Push out of the triangle plane towards the side the box center is on. Depth is
+            // measured after earlier pushes, so coplanar neighbours do not push twice.
+            glm::vec3 normal(triangles->nx[hit], triangles->ny[hit], triangles->nz[hit]);
+            float radius = glm::dot(body.halfExtents, glm::abs(normal));
+            float distance = glm::dot(normal, body.center - spaceOffset) - triangles->nd[hit];
+            if (distance < 0.0f) {
+                normal = -normal;
+            }
+
+            float depth = radius - std::abs(distance);
+            if (depth > 0.0f) {
+                body.center += normal * (depth + SKIN_WIDTH);
+                body.needsOverlapCheck = true;
+            }
+            addToManifold(body, instance, meshTriangle, normal);
+        }
+    });
+}
+
+bool CollisionWorld::sweep(const glm::vec3& center, const glm::vec3& halfExtents, const glm::vec3& displacement,
+    JobScratch& scratch, SweepHit& hit, const CollisionInstance*& hitInstance) const {
+    // Everything the box can touch lies within its start and end boxes' union
+    CollisionBounds sweptBounds;
+    sweptBounds.grow(center - halfExtents);
+    sweptBounds.grow(center + halfExtents);
+    sweptBounds.grow(center - halfExtents + displacement);
+    sweptBounds.grow(center + halfExtents + displacement);
+
+    bool found = false;
+    m_Scene.queryInstances(sweptBounds, [&](const CollisionInstance& instance, const CollisionBounds& localBounds) {
+        glm::vec3 spaceOffset;
+        const CollisionTriangleSoA* triangles = collectCandidates(instance, localBounds, scratch, spaceOffset);
+        if (triangles && SATKernel::sweepBox(*triangles, scratch.candidateRanges, center - spaceOffset, halfExtents,
+            displacement, hit)) {
+            // Translate now, while scratch still describes this instance
+            hit.triangle = getMeshTriangle(scratch, hit.triangle);
+            hitInstance = &instance;
+            found = true;
+        }
+    });
+    return found;
+}
+
+const CollisionTriangleSoA* CollisionWorld::collectCandidates(const CollisionInstance& instance,
+    const CollisionBounds& localBounds, JobScratch& scratch, glm::vec3& spaceOffset) const {
+    const CollisionHeightfield* heightfield = instance.mesh->getHeightfield();
+    scratch.hasGatheredTriangles = false;
+
+    if (!heightfield) {
+        scratch.candidateRanges.clear();
+        instance.mesh->collectLeaves(localBounds, scratch.candidateRanges);
+        if (scratch.candidateRanges.empty()) {
+            return nullptr;
+        }
+
+        if (instance.isTranslationOnly) {
+            spaceOffset = instance.translation;
+            return &instance.mesh->getTriangles();
+        }
+    }
+
+    // Heightfield cells, or candidates of a rotated or scaled instance: gather just those
+    // triangles, in a space where the box is axis-aligned, and precompute their SAT data on the fly
+    scratch.gatheredTriangles.clear();
+    scratch.candidateTriangles.clear();
+    auto gather = [&](uint32_t index, const CollisionTriangle& triangle) {
+        scratch.gatheredTriangles.push_back(instance.isTranslationOnly ? triangle : toWorldSpace(instance, triangle));
+        scratch.candidateTriangles.push_back(index);
+    };
+
+    if (heightfield) {
+        heightfield->query(localBounds, gather);
+        if (scratch.gatheredTriangles.empty()) {
+            return nullptr;
+        }
+    }
+    else {
+        const CollisionTriangleSoA& triangles = instance.mesh->getTriangles();
+        for (const TriangleRange& range : scratch.candidateRanges) {
+            for (uint32_t i = range.first; i < range.first + range.count; i++) {
+                gather(i, triangles.getTriangle(i));
+            }
+        }
+    }
+
+    scratch.gatheredTriangleSoA.assign(scratch.gatheredTriangles, &scratch.keptTriangles);
+    scratch.candidateRanges.assign(1, { 0, static_cast<uint32_t>(scratch.gatheredTriangleSoA.count) });
+    scratch.hasGatheredTriangles = true;
+    spaceOffset = instance.isTranslationOnly ? instance.translation : glm::vec3(0.0f);
+    return &scratch.gatheredTriangleSoA;
+}
+
+uint32_t CollisionWorld::getMeshTriangle(const JobScratch& scratch, uint32_t candidate) {
+    if (!scratch.hasGatheredTriangles) {
+        return candidate;
+    }
+    return scratch.candidateTriangles[scratch.keptTriangles[candidate]];
+}
+
+CollisionTriangle CollisionWorld::toWorldSpace(const CollisionInstance& instance, const CollisionTriangle& triangle) {
+    CollisionTriangle world;
+    world.v0 = glm::vec3(instance.transform * glm::vec4(triangle.v0, 1.0f));
+    world.v1 = glm::vec3(instance.transform * glm::vec4(triangle.v1, 1.0f));
+    world.v2 = glm::vec3(instance.transform * glm::vec4(triangle.v2, 1.0f));
+    world.normal = glm::normalize(glm::cross(world.v1 - world.v0, world.v2 - world.v0));
+    return world;
+}
@@ -0,0 +1,169 @@
+#pragma once
+#include "collision_scene.h"
+#include "sat_kernel.h"
+#include "thread_pool.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+enum class GroundState {
+    Airborne,
+    Grounded,  // Standing on a surface flat enough to walk on
+    Sliding,   // Resting only against surfaces too steep to stand on
+};
+
+// A contact a body keeps across steps, keyed by instance and triangle. Its plane and bounds are
+// world space, valid while the instance keeps the revision it had when the contact was made.
+struct ManifoldContact {
+    uint64_t instanceID = 0;
+    uint32_t triangle = 0;
+    uint64_t instanceRevision = 0;
+    glm::vec3 normal = glm::vec3(0.0f);  // Separating axis, pointing towards the body
+    float planeOffset = 0.0f;            // Furthest extent of the triangle along normal
+    CollisionBounds bounds;
+};
+
+// Axis-aligned box moved through the world geometry by CollisionWorld::step
+struct CollisionBody {
+    static constexpr int MAX_MANIFOLD_CONTACTS = 8;
+
+    uint64_t id = 0;  // Caller-chosen
+    glm::vec3 center = glm::vec3(0.0f);
+    glm::vec3 halfExtents = glm::vec3(0.5f);
+    // Movement requested for the next step; consumed by it
+    glm::vec3 displacement = glm::vec3(0.0f);
+    // Contacts after the last step: getContacts()[firstContact, firstContact + contactCount)
+    uint32_t firstContact = 0;
+    uint32_t contactCount = 0;
+    GroundState groundState = GroundState::Airborne;
+
+    // Maintained by CollisionWorld between steps
+    ManifoldContact manifold[MAX_MANIFOLD_CONTACTS];
+    uint32_t manifoldCount = 0;
+    uint64_t checkedSceneRevision = 0;  // Scene revision of the last overlap pass
+    bool needsOverlapCheck = true;
+};
+
+// A surface a body touches after a step: its manifold, flattened for callers
+struct CollisionContact {
+    uint64_t instanceID = 0;
+    uint32_t triangle = 0;                // Index into the instance mesh's triangles
+    glm::vec3 normal = glm::vec3(0.0f);   // Unit, world space, pointing from the surface towards the body
+};
+
+// One ray or segment for CollisionWorld::raycast
+struct CollisionRay {
+    glm::vec3 origin = glm::vec3(0.0f);
+    glm::vec3 direction = glm::vec3(0.0f, -1.0f, 0.0f);  // Unit length, so distances are in world units
+    float maxDistance = std::numeric_limits<float>::max();
+
+    // From start to end; a zero-length segment hits nothing
+    static CollisionRay segment(const glm::vec3& start, const glm::vec3& end);
+};
+
+// Closest surface along a ray
+struct RaycastHit {
+    bool hit = false;
+    float distance = 0.0f;                // Along the ray
+    glm::vec3 point = glm::vec3(0.0f);
+    glm::vec3 normal = glm::vec3(0.0f);   // Unit, world space, facing back towards the ray origin
+    uint64_t instanceID = 0;
+    uint32_t triangle = 0;                // Index into the instance mesh's triangles
+};
+
+// Many boxes against the shared static geometry in m_Scene. Bodies do not collide with
+// each other, so step() runs every body's sweep and overlap queries independently on the
+// worker pool. Each job writes contacts into its own buffer; buffers are merged in body
+// order afterwards, so results do not depend on thread timing.
+class CollisionWorld {
+private:
+    // Everything one job touches while stepping its bodies
+    struct JobScratch {
+        std::vector<TriangleRange> candidateRanges;
+        // Set when candidates were gathered into gatheredTriangleSoA rather than read from the mesh's own SoA
+        bool hasGatheredTriangles = false;
+        std::vector<uint32_t> candidateTriangles;  // Mesh index of each gathered candidate
+        std::vector<uint32_t> keptTriangles;
+        std::vector<uint32_t> hits;
+        std::vector<CollisionTriangle> gatheredTriangles;
+        CollisionTriangleSoA gatheredTriangleSoA;
+        std::vector<CollisionContact> contacts;
+        size_t firstBody = 0;
+        size_t endBody = 0;
+    };
+
+    ThreadPool& m_Pool;
+    CollisionScene m_Scene;
+    std::vector<CollisionBody> m_Bodies;
+    std::unordered_map<uint64_t, uint32_t> m_BodySlots;  // id -> index in m_Bodies
+    std::vector<JobScratch> m_Scratch;
+    std::vector<CollisionContact> m_Contacts;
+
+    // Body queries; only read m_Scene, so jobs can run them concurrently
+    void stepBody(CollisionBody& body, JobScratch& scratch) const;
+    void clipAgainstManifold(const CollisionBody& body, glm::vec3& displacement) const;
+    void revalidateManifold(CollisionBody& body) const;
+    void addToManifold(CollisionBody& body, const CollisionInstance& instance, uint32_t triangle, const glm::vec3& normal) const;
+    static bool isInManifold(const CollisionBody& body, uint64_t instanceID, uint32_t triangle);
+    static GroundState classifyGround(const CollisionBody& body);
+    void moveAndSlide(CollisionBody& body, glm::vec3 displacement, JobScratch& scratch) const;
+    void resolveOverlaps(CollisionBody& body, JobScratch& scratch) const;
+    bool sweep(const glm::vec3& center, const glm::vec3& halfExtents, const glm::vec3& displacement,
+        JobScratch& scratch, SweepHit& hit, const CollisionInstance*& hitInstance) const;
+    const CollisionTriangleSoA* collectCandidates(const CollisionInstance& instance, const CollisionBounds& localBounds,
+        JobScratch& scratch, glm::vec3& spaceOffset) const;
+    static uint32_t getMeshTriangle(const JobScratch& scratch, uint32_t candidate);
+    static CollisionTriangle toWorldSpace(const CollisionInstance& instance, const CollisionTriangle& triangle);
+
+public:
+    // A hit consumes the move up to the contact; the rest slides along the surface and is swept again
+    static constexpr int MAX_SLIDE_ITERATIONS = 4;
+    // Gap kept between a body and a surface it was stopped at, so the next sweep starts separated
+    static constexpr float SKIN_WIDTH = 0.001f;
+    // Manifold contacts further from the body than this are dropped
+    static constexpr float CONTACT_MARGIN = 0.02f;
+    // Contact normals at least this upright (about 45 degrees) count as ground
+    static constexpr float MIN_GROUND_NORMAL_Y = 0.7f;
+    // Smaller jobs cost more to schedule than their queries take
+    static constexpr size_t MIN_BODIES_PER_JOB = 16;
+    static constexpr size_t MIN_RAYS_PER_JOB = 64;
+
+    // Jobs run on pool, normally the shared one; it must outlive the world
+    explicit CollisionWorld(ThreadPool& pool = ThreadPool::getShared());
+
+    CollisionScene& getScene() { return m_Scene; }
+    const CollisionScene& getScene() const { return m_Scene; }
+
+    // Adds the body or teleports it; a pending displacement is kept. Moving the body drops its contacts.
+    void setBody(uint64_t id, const glm::vec3& center, const glm::vec3& halfExtents);
+    void removeBody(uint64_t id);
+    // Adds to the movement applied by the next step
+    void moveBody(uint64_t id, const glm::vec3& displacement);
+    const CollisionBody* getBody(uint64_t id) const;
+
+    // Sweeps every body along its displacement with slide response, then pushes it out of
+    // anything new it overlaps. Contacts that are still valid carry over from the last step:
+    // they are revalidated against their stored plane, clip the displacement before it is
+    // swept, and are left out of the full overlap test. A body that did not move in an
+    // unchanged scene skips the overlap pass entirely. Bring the scene up to date before calling.
+    void step();
+
+    const std::vector<CollisionBody>& getBodies() const { return m_Bodies; }
+    const std::vector<CollisionContact>& getContacts() const { return m_Contacts; }
+
+    // Closest hit of one ray against the scene; false and hit.hit unset if it reaches nothing
+    bool raycast(const CollisionRay& ray, RaycastHit& hit) const;
+    // Closest hit of every ray, hits[i] for rays[i]. Rays are independent, so they are split into
+    // jobs on the worker pool and need no merging. Each walks the instance tree and the mesh BVHs
+    // nearest first and stops searching beyond its closest hit so far. Bring the scene up to date
+    // before calling.
+    void raycast(const std::vector<CollisionRay>& rays, std::vector<RaycastHit>& hits) const;
+
+    // Highest heightfield surface at (x, z) no higher than maxHeight; false if there is none.
+    // O(1) per heightfield instance. Rotated or scaled instances are not considered.
+    bool getGroundHeight(float x, float z, float maxHeight, float& height) const;
+
+    ThreadPool& getPool() const { return m_Pool; }
+};
@@ -0,0 +1,219 @@
+#include "ray_kernel.h"
+#include "sat_kernel.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define COLLISION_SIMD_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#define COLLISION_TARGET_AVX2
+#else
+#define COLLISION_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+    bool intersectScalar(const CollisionTriangleSoA& t, uint32_t first, uint32_t count,
+        const glm::vec3& o, const glm::vec3& d, float& distance, uint32_t& triangle) {
+        bool found = false;
+        for (uint32_t i = first; i < first + count; i++) {
+            glm::vec3 e1(t.e1x[i], t.e1y[i], t.e1z[i]);
+            glm::vec3 e2(t.e2x[i], t.e2y[i], t.e2z[i]);
+            glm::vec3 p = glm::cross(d, e2);
+            float determinant = glm::dot(e1, p);
+            if (std::abs(determinant) < RayKernel::MIN_DETERMINANT) {
+                continue;
+            }
+
+            float inverse = 1.0f / determinant;
+            glm::vec3 s = o - glm::vec3(t.v0x[i], t.v0y[i], t.v0z[i]);
+            float u = glm::dot(s, p) * inverse;
+            if (u < 0.0f || u > 1.0f) {
+                continue;
+            }
+            glm::vec3 q = glm::cross(s, e1);
+            float v = glm::dot(d, q) * inverse;
+            float hitDistance = glm::dot(e2, q) * inverse;
+            if (v < 0.0f || u + v > 1.0f || hitDistance < 0.0f || hitDistance >= distance) {
+                continue;
+            }
+
+            distance = hitDistance;
+            triangle = i;
+            found = true;
+        }
+        return found;
+    }
+
+    // Keeps the nearest of the lanes in mask; lane i is triangle first + i
+    bool takeClosest(int mask, const float* laneDistances, uint32_t first, float& distance, uint32_t& triangle) {
+        bool found = false;
+        while (mask) {
+            int lane = 0;
+            while (!(mask & (1 << lane))) lane++;
+            if (laneDistances[lane] < distance) {
+                distance = laneDistances[lane];
+                triangle = first + lane;
+                found = true;
+            }
+            mask &= mask - 1;
+        }
+        return found;
+    }
+
+#ifdef COLLISION_SIMD_X86
+    // Bitmask of the 4 triangles at first hit nearer than best; their distances go to hitDistance.
+    // Padding lanes divide by zero or compare NaN and drop out.
+    inline int intersectMaskSSE(const CollisionTriangleSoA& t, uint32_t first, const __m128 o[3], const __m128 d[3],
+        __m128 best, __m128& hitDistance) {
+        __m128 e1x = _mm_loadu_ps(&t.e1x[first]), e1y = _mm_loadu_ps(&t.e1y[first]), e1z = _mm_loadu_ps(&t.e1z[first]);
+        __m128 e2x = _mm_loadu_ps(&t.e2x[first]), e2y = _mm_loadu_ps(&t.e2y[first]), e2z = _mm_loadu_ps(&t.e2z[first]);
+
+        // p = d x e2, determinant = e1 . p
+        __m128 px = _mm_sub_ps(_mm_mul_ps(d[1], e2z), _mm_mul_ps(d[2], e2y));
+        __m128 py = _mm_sub_ps(_mm_mul_ps(d[2], e2x), _mm_mul_ps(d[0], e2z));
+        __m128 pz = _mm_sub_ps(_mm_mul_ps(d[0], e2y), _mm_mul_ps(d[1], e2x));
+        __m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+        __m128 inverse = _mm_div_ps(_mm_set1_ps(1.0f), determinant);
+
+        // s = o - v0, u = (s . p) / determinant
+        __m128 sx = _mm_sub_ps(o[0], _mm_loadu_ps(&t.v0x[first]));
+        __m128 sy = _mm_sub_ps(o[1], _mm_loadu_ps(&t.v0y[first]));
+        __m128 sz = _mm_sub_ps(o[2], _mm_loadu_ps(&t.v0z[first]));
+        __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inverse);
+
+        // q = s x e1, v = (d . q) / determinant, t = (e2 . q) / determinant
+        __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+        __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+        __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+        __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(d[0], qx), _mm_mul_ps(d[1], qy)), _mm_mul_ps(d[2], qz)), inverse);
+        hitDistance = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inverse);
+
+        const __m128 zero = _mm_setzero_ps();
+        __m128 absDeterminant = _mm_andnot_ps(_mm_set1_ps(-0.0f), determinant);
+        __m128 hit = _mm_and_ps(
+            _mm_and_ps(_mm_cmpge_ps(absDeterminant, _mm_set1_ps(RayKernel::MIN_DETERMINANT)), _mm_cmpge_ps(u, zero)),
+            _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f))));
+        hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(hitDistance, zero), _mm_cmplt_ps(hitDistance, best)));
+        return _mm_movemask_ps(hit);
+    }
+
+    bool intersectSSE(const CollisionTriangleSoA& t, uint32_t first, uint32_t count,
+        const glm::vec3& origin, const glm::vec3& direction, float& distance, uint32_t& triangle) {
+        const __m128 o[3] = { _mm_set1_ps(origin.x), _mm_set1_ps(origin.y), _mm_set1_ps(origin.z) };
+        const __m128 d[3] = { _mm_set1_ps(direction.x), _mm_set1_ps(direction.y), _mm_set1_ps(direction.z) };
+
+        bool found = false;
+        for (uint32_t i = first; i < first + count; i += 4) {
+            // Lanes past the end may belong to other leaves
+            uint32_t lanes = std::min(4u, first + count - i);
+            __m128 hitDistance;
+            int mask = intersectMaskSSE(t, i, o, d, _mm_set1_ps(distance), hitDistance) & ((1 << lanes) - 1);
+            if (mask) {
+                alignas(16) float laneDistances[4];
+                _mm_store_ps(laneDistances, hitDistance);
+                found |= takeClosest(mask, laneDistances, i, distance, triangle);
+            }
+        }
+        return found;
+    }
+
+    COLLISION_TARGET_AVX2
+    inline int intersectMaskAVX2(const CollisionTriangleSoA& t, uint32_t first, const __m256 o[3], const __m256 d[3],
+        __m256 best, __m256& hitDistance) {
+        __m256 e1x = _mm256_loadu_ps(&t.e1x[first]), e1y = _mm256_loadu_ps(&t.e1y[first]), e1z = _mm256_loadu_ps(&t.e1z[first]);
+        __m256 e2x = _mm256_loadu_ps(&t.e2x[first]), e2y = _mm256_loadu_ps(&t.e2y[first]), e2z = _mm256_loadu_ps(&t.e2z[first]);
+
+        __m256 px = _mm256_sub_ps(_mm256_mul_ps(d[1], e2z), _mm256_mul_ps(d[2], e2y));
+        __m256 py = _mm256_sub_ps(_mm256_mul_ps(d[2], e2x), _mm256_mul_ps(d[0], e2z));
+        __m256 pz = _mm256_sub_ps(_mm256_mul_ps(d[0], e2y), _mm256_mul_ps(d[1], e2x));
+        __m256 determinant = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e1x, px), _mm256_mul_ps(e1y, py)), _mm256_mul_ps(e1z, pz));
+        __m256 inverse = _mm256_div_ps(_mm256_set1_ps(1.0f), determinant);
+
+        __m256 sx = _mm256_sub_ps(o[0], _mm256_loadu_ps(&t.v0x[first]));
+        __m256 sy = _mm256_sub_ps(o[1], _mm256_loadu_ps(&t.v0y[first]));
+        __m256 sz = _mm256_sub_ps(o[2], _mm256_loadu_ps(&t.v0z[first]));
+        __m256 u = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sx, px), _mm256_mul_ps(sy, py)), _mm256_mul_ps(sz, pz)), inverse);
+
+        __m256 qx = _mm256_sub_ps(_mm256_mul_ps(sy, e1z), _mm256_mul_ps(sz, e1y));
+        __m256 qy = _mm256_sub_ps(_mm256_mul_ps(sz, e1x), _mm256_mul_ps(sx, e1z));
+        __m256 qz = _mm256_sub_ps(_mm256_mul_ps(sx, e1y), _mm256_mul_ps(sy, e1x));
+        __m256 v = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(d[0], qx), _mm256_mul_ps(d[1], qy)), _mm256_mul_ps(d[2], qz)), inverse);
+        hitDistance = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e2x, qx), _mm256_mul_ps(e2y, qy)), _mm256_mul_ps(e2z, qz)), inverse);
+
+        const __m256 zero = _mm256_setzero_ps();
+        __m256 absDeterminant = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), determinant);
+        __m256 hit = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(absDeterminant, _mm256_set1_ps(RayKernel::MIN_DETERMINANT), _CMP_GE_OQ),
+                _mm256_cmp_ps(u, zero, _CMP_GE_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(v, zero, _CMP_GE_OQ),
+                _mm256_cmp_ps(_mm256_add_ps(u, v), _mm256_set1_ps(1.0f), _CMP_LE_OQ)));
+        hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(hitDistance, zero, _CMP_GE_OQ),
+            _mm256_cmp_ps(hitDistance, best, _CMP_LT_OQ)));
+        return _mm256_movemask_ps(hit);
+    }
+
+    COLLISION_TARGET_AVX2
+    bool intersectAVX2(const CollisionTriangleSoA& t, uint32_t first, uint32_t count,
+        const glm::vec3& origin, const glm::vec3& direction, float& distance, uint32_t& triangle) {
+        const __m256 o[3] = { _mm256_set1_ps(origin.x), _mm256_set1_ps(origin.y), _mm256_set1_ps(origin.z) };
+        const __m256 d[3] = { _mm256_set1_ps(direction.x), _mm256_set1_ps(direction.y), _mm256_set1_ps(direction.z) };
+
+        // 8 lanes while more than a half-full batch remains; a BVH leaf or the tail goes 4-wide
+        bool found = false;
+        uint32_t i = first;
+        for (; first + count - i > 4; i += 8) {
+            uint32_t lanes = std::min(8u, first + count - i);
+            __m256 hitDistance;
+            int mask = intersectMaskAVX2(t, i, o, d, _mm256_set1_ps(distance), hitDistance) & ((1 << lanes) - 1);
+            if (mask) {
+                alignas(32) float laneDistances[8];
+                _mm256_store_ps(laneDistances, hitDistance);
+                found |= takeClosest(mask, laneDistances, i, distance, triangle);
+            }
+        }
+        if (i < first + count) {
+            found |= intersectSSE(t, i, first + count - i, origin, direction, distance, triangle);
+        }
+        return found;
+    }
+#endif
+}
+
+bool RayKernel::intersect(const CollisionTriangleSoA& triangles, uint32_t first, uint32_t count,
+    const glm::vec3& origin, const glm::vec3& direction, float& distance, uint32_t& triangle) {
+    switch (SATKernel::getLevel()) {
+#ifdef COLLISION_SIMD_X86
+    case SATKernel::Level::AVX2:
+        return intersectAVX2(triangles, first, count, origin, direction, distance, triangle);
+    case SATKernel::Level::SSE:
+        return intersectSSE(triangles, first, count, origin, direction, distance, triangle);
+#endif
+    default:
+        return intersectScalar(triangles, first, count, origin, direction, distance, triangle);
+    }
+}
+
+bool RayKernel::intersectTriangle(const CollisionTriangle& triangle, const glm::vec3& origin, const glm::vec3& direction,
+    float& distance) {
+    glm::vec3 e1 = triangle.v1 - triangle.v0;
+    glm::vec3 e2 = triangle.v2 - triangle.v0;
+    glm::vec3 p = glm::cross(direction, e2);
+    float determinant = glm::dot(e1, p);
+    if (std::abs(determinant) < MIN_DETERMINANT) {
+        return false;
+    }
+
+    float inverse = 1.0f / determinant;
+    glm::vec3 s = origin - triangle.v0;
+    float u = glm::dot(s, p) * inverse;
+    glm::vec3 q = glm::cross(s, e1);
+    float v = glm::dot(direction, q) * inverse;
+    float hitDistance = glm::dot(e2, q) * inverse;
+    if (u < 0.0f || v < 0.0f || u + v > 1.0f || hitDistance < 0.0f || hitDistance >= distance) {
+        return false;
+    }
+    distance = hitDistance;
+    return true;
+}
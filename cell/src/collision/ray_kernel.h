@@ -0,0 +1,23 @@
+#pragma once
+#include "collision_triangle.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+
+// Möller–Trumbore ray/triangle intersection over the v0/e1/e2 arrays of CollisionTriangleSoA,
+// 4 or 8 triangles per iteration. Both faces count as hits. Runs at the level SATKernel is
+// set to, so benchmarks and fallbacks switch every collision kernel together.
+class RayKernel {
+public:
+    // Determinants smaller than this are treated as a ray parallel to the triangle
+    static constexpr float MIN_DETERMINANT = 1e-12f;
+
+    // Closest hit of origin + t * direction with triangles [first, first + count). Only hits
+    // with t < distance replace distance and triangle, so one pair can collect the closest
+    // hit across several calls.
+    static bool intersect(const CollisionTriangleSoA& triangles, uint32_t first, uint32_t count,
+        const glm::vec3& origin, const glm::vec3& direction, float& distance, uint32_t& triangle);
+
+    // Single triangle; true and distance set if it is hit with 0 <= t < distance
+    static bool intersectTriangle(const CollisionTriangle& triangle, const glm::vec3& origin, const glm::vec3& direction,
+        float& distance);
+};
@@ -0,0 +1,424 @@
+#include "sat_kernel.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define COLLISION_SIMD_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define COLLISION_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define COLLISION_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+    // Components spanned by cross axis i: world axis i % 3 contributes nothing
+    constexpr int CROSS_COMPONENT_A[3] = { 1, 0, 0 };
+    constexpr int CROSS_COMPONENT_B[3] = { 2, 2, 1 };
+
+    SATKernel::Level detectSupportedLevel() {
+#ifdef COLLISION_SIMD_X86
+        bool hasAVX2 = false;
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] >= 7) {
+            __cpuid(info, 1);
+            bool osSavesYMM = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+            __cpuidex(info, 7, 0);
+            hasAVX2 = osSavesYMM && (info[1] & (1 << 5));
+        }
+#else
+        hasAVX2 = __builtin_cpu_supports("avx2");
+#endif
+        return hasAVX2 ? SATKernel::Level::AVX2 : SATKernel::Level::SSE;
+#else
+        return SATKernel::Level::Scalar;
+#endif
+    }
+
+    std::atomic<SATKernel::Level>& activeLevel() {
+        static std::atomic<SATKernel::Level> level{ SATKernel::getSupportedLevel() };
+        return level;
+    }
+
+    bool overlapsScalar(const CollisionTriangleSoA& t, uint32_t i, const glm::vec3& c, const glm::vec3& h) {
+        // 1. Box face axes: the triangle's bounds
+        if (c.x - h.x > t.maxX[i] || c.x + h.x < t.minX[i] ||
+            c.y - h.y > t.maxY[i] || c.y + h.y < t.minY[i] ||
+            c.z - h.z > t.maxZ[i] || c.z + h.z < t.minZ[i]) {
+            return false;
+        }
+
+        // 2. Triangle normal
+        float distance = t.nx[i] * c.x + t.ny[i] * c.y + t.nz[i] * c.z - t.nd[i];
+        float radius = h.x * std::abs(t.nx[i]) + h.y * std::abs(t.ny[i]) + h.z * std::abs(t.nz[i]);
+        if (std::abs(distance) > radius) {
+            return false;
+        }
+
+        // 3. Edge cross products: project the box, compare with the stored extent
+        for (int axis = 0; axis < CollisionTriangleSoA::CROSS_AXIS_COUNT; axis++) {
+            int a = CROSS_COMPONENT_A[axis % 3];
+            int b = CROSS_COMPONENT_B[axis % 3];
+            float axisA = t.crossA[axis][i];
+            float axisB = t.crossB[axis][i];
+            float center = axisA * c[a] + axisB * c[b];
+            float boxRadius = h[a] * std::abs(axisA) + h[b] * std::abs(axisB);
+            if (center - boxRadius > t.crossMax[axis][i] || center + boxRadius < t.crossMin[axis][i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void overlapBoxScalar(const CollisionTriangleSoA& triangles, const std::vector<TriangleRange>& ranges,
+        const glm::vec3& c, const glm::vec3& h, std::vector<uint32_t>& hits) {
+        for (const TriangleRange& range : ranges) {
+            for (uint32_t i = range.first; i < range.first + range.count; i++) {
+                if (overlapsScalar(triangles, i, c, h)) {
+                    hits.push_back(i);
+                }
+            }
+        }
+    }
+
+    // Interval of time during which the box and triangle overlap when projected onto one axis
+    struct SweepInterval {
+        float enter = -std::numeric_limits<float>::infinity();
+        float exit = std::numeric_limits<float>::infinity();
+        glm::vec3 normal = glm::vec3(0.0f);
+    };
+
+    // Narrows interval by one axis; false once the axis separates the box for the whole sweep.
+    // boxCenter and speed are the box's projected center and velocity, boxRadius its projected half size.
+    bool sweepAxis(const glm::vec3& axis, float boxCenter, float boxRadius, float speed,
+        float triangleMin, float triangleMax, SweepInterval& interval) {
+        float boxMin = boxCenter - boxRadius;
+        float boxMax = boxCenter + boxRadius;
+
+        float enter, exit;
+        if (boxMax < triangleMin) {
+            // Box below the triangle on this axis, has to move up to touch it
+            if (speed <= 0.0f) {
+                return false;
+            }
+            enter = (triangleMin - boxMax) / speed;
+            exit = (triangleMax - boxMin) / speed;
+            if (enter > interval.enter) {
+                interval.enter = enter;
+                interval.normal = -axis;
+            }
+        }
+        else if (boxMin > triangleMax) {
+            if (speed >= 0.0f) {
+                return false;
+            }
+            enter = (triangleMax - boxMin) / speed;
+            exit = (triangleMin - boxMax) / speed;
+            if (enter > interval.enter) {
+                interval.enter = enter;
+                interval.normal = axis;
+            }
+        }
+        else {
+            // Already overlapping on this axis; only the exit time matters
+            if (speed > 0.0f) {
+                exit = (triangleMax - boxMin) / speed;
+            }
+            else if (speed < 0.0f) {
+                exit = (triangleMin - boxMax) / speed;
+            }
+            else {
+                exit = std::numeric_limits<float>::infinity();
+            }
+        }
+
+        interval.exit = std::min(interval.exit, exit);
+        return interval.enter <= interval.exit && interval.enter <= 1.0f;
+    }
+
+    // True if the box moving by d hits the triangle; interval.enter is then the time of impact.
+    // False if it misses or starts out overlapping.
+    bool sweepScalar(const CollisionTriangleSoA& t, uint32_t i, const glm::vec3& c, const glm::vec3& h,
+        const glm::vec3& d, SweepInterval& interval) {
+        // 1. Box face axes
+        if (!sweepAxis(glm::vec3(1.0f, 0.0f, 0.0f), c.x, h.x, d.x, t.minX[i], t.maxX[i], interval) ||
+            !sweepAxis(glm::vec3(0.0f, 1.0f, 0.0f), c.y, h.y, d.y, t.minY[i], t.maxY[i], interval) ||
+            !sweepAxis(glm::vec3(0.0f, 0.0f, 1.0f), c.z, h.z, d.z, t.minZ[i], t.maxZ[i], interval)) {
+            return false;
+        }
+
+        // 2. Triangle normal
+        glm::vec3 normal(t.nx[i], t.ny[i], t.nz[i]);
+        if (!sweepAxis(normal, glm::dot(normal, c), glm::dot(h, glm::abs(normal)), glm::dot(normal, d),
+            t.nd[i], t.nd[i], interval)) {
+            return false;
+        }
+
+        // 3. Edge cross products
+        for (int axis = 0; axis < CollisionTriangleSoA::CROSS_AXIS_COUNT; axis++) {
+            int a = CROSS_COMPONENT_A[axis % 3];
+            int b = CROSS_COMPONENT_B[axis % 3];
+            glm::vec3 direction(0.0f);
+            direction[a] = t.crossA[axis][i];
+            direction[b] = t.crossB[axis][i];
+            if (!sweepAxis(direction, glm::dot(direction, c), glm::dot(h, glm::abs(direction)), glm::dot(direction, d),
+                t.crossMin[axis][i], t.crossMax[axis][i], interval)) {
+                return false;
+            }
+        }
+
+        // Overlapping on every axis at the start: no entry time to report
+        return interval.enter >= 0.0f;
+    }
+
+#ifdef COLLISION_SIMD_X86
+    // Bitmask of the 4 triangles starting at first that overlap the box
+    inline int overlapMaskSSE(const CollisionTriangleSoA& t, uint32_t first, const __m128 c[3], const __m128 h[3]) {
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+
+        // 1. Box face axes
+        __m128 boxMin[3], boxMax[3];
+        for (int axis = 0; axis < 3; axis++) {
+            boxMin[axis] = _mm_sub_ps(c[axis], h[axis]);
+            boxMax[axis] = _mm_add_ps(c[axis], h[axis]);
+        }
+        __m128 separated = _mm_or_ps(_mm_cmpgt_ps(boxMin[0], _mm_loadu_ps(&t.maxX[first])), _mm_cmplt_ps(boxMax[0], _mm_loadu_ps(&t.minX[first])));
+        separated = _mm_or_ps(separated, _mm_or_ps(_mm_cmpgt_ps(boxMin[1], _mm_loadu_ps(&t.maxY[first])), _mm_cmplt_ps(boxMax[1], _mm_loadu_ps(&t.minY[first]))));
+        separated = _mm_or_ps(separated, _mm_or_ps(_mm_cmpgt_ps(boxMin[2], _mm_loadu_ps(&t.maxZ[first])), _mm_cmplt_ps(boxMax[2], _mm_loadu_ps(&t.minZ[first]))));
+
+        // Most candidates fail on their bounds; skip the remaining loads when all lanes did
+        if (_mm_movemask_ps(separated) == 0xF) {
+            return 0;
+        }
+
+        // 2. Triangle normal
+        __m128 nx = _mm_loadu_ps(&t.nx[first]);
+        __m128 ny = _mm_loadu_ps(&t.ny[first]);
+        __m128 nz = _mm_loadu_ps(&t.nz[first]);
+        __m128 distance = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, c[0]), _mm_mul_ps(ny, c[1])), _mm_mul_ps(nz, c[2])),
+            _mm_loadu_ps(&t.nd[first]));
+        __m128 radius = _mm_add_ps(_mm_add_ps(
+            _mm_mul_ps(h[0], _mm_andnot_ps(signMask, nx)),
+            _mm_mul_ps(h[1], _mm_andnot_ps(signMask, ny))),
+            _mm_mul_ps(h[2], _mm_andnot_ps(signMask, nz)));
+        separated = _mm_or_ps(separated, _mm_cmpgt_ps(_mm_andnot_ps(signMask, distance), radius));
+        if (_mm_movemask_ps(separated) == 0xF) {
+            return 0;
+        }
+
+        // 3. Edge cross products
+        for (int axis = 0; axis < CollisionTriangleSoA::CROSS_AXIS_COUNT; axis++) {
+            int a = CROSS_COMPONENT_A[axis % 3];
+            int b = CROSS_COMPONENT_B[axis % 3];
+            __m128 axisA = _mm_loadu_ps(&t.crossA[axis][first]);
+            __m128 axisB = _mm_loadu_ps(&t.crossB[axis][first]);
+            __m128 center = _mm_add_ps(_mm_mul_ps(axisA, c[a]), _mm_mul_ps(axisB, c[b]));
+            __m128 boxRadius = _mm_add_ps(_mm_mul_ps(h[a], _mm_andnot_ps(signMask, axisA)), _mm_mul_ps(h[b], _mm_andnot_ps(signMask, axisB)));
+            separated = _mm_or_ps(separated, _mm_or_ps(
+                _mm_cmpgt_ps(_mm_sub_ps(center, boxRadius), _mm_loadu_ps(&t.crossMax[axis][first])),
+                _mm_cmplt_ps(_mm_add_ps(center, boxRadius), _mm_loadu_ps(&t.crossMin[axis][first]))));
+        }
+
+        return ~_mm_movemask_ps(separated) & 0xF;
+    }
+
+    void overlapBoxSSE(const CollisionTriangleSoA& triangles, const std::vector<TriangleRange>& ranges,
+        const glm::vec3& boxCenter, const glm::vec3& boxHalfExtents, std::vector<uint32_t>& hits) {
+        const __m128 c[3] = { _mm_set1_ps(boxCenter.x), _mm_set1_ps(boxCenter.y), _mm_set1_ps(boxCenter.z) };
+        const __m128 h[3] = { _mm_set1_ps(boxHalfExtents.x), _mm_set1_ps(boxHalfExtents.y), _mm_set1_ps(boxHalfExtents.z) };
+
+        for (const TriangleRange& range : ranges) {
+            for (uint32_t first = range.first; first < range.first + range.count; first += 4) {
+                // Lanes past the end of the range may belong to other leaves
+                uint32_t lanes = std::min(4u, range.first + range.count - first);
+                int mask = overlapMaskSSE(triangles, first, c, h) & ((1 << lanes) - 1);
+                while (mask) {
+                    int lane = 0;
+                    while (!(mask & (1 << lane))) lane++;
+                    hits.push_back(first + lane);
+                    mask &= mask - 1;
+                }
+            }
+        }
+    }
+
+    COLLISION_TARGET_AVX2
+    inline __m256 load2x4(const std::vector<float>& data, uint32_t low, uint32_t high) {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&data[low])), _mm_loadu_ps(&data[high]), 1);
+    }
+
+    // Bitmask of 8 triangles: lanes 0-3 start at low, lanes 4-7 at high
+    COLLISION_TARGET_AVX2
+    inline int overlapMaskAVX2(const CollisionTriangleSoA& t, uint32_t low, uint32_t high, const __m256 c[3], const __m256 h[3]) {
+        const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+        // 1. Box face axes
+        __m256 boxMin[3], boxMax[3];
+        for (int axis = 0; axis < 3; axis++) {
+            boxMin[axis] = _mm256_sub_ps(c[axis], h[axis]);
+            boxMax[axis] = _mm256_add_ps(c[axis], h[axis]);
+        }
+        __m256 separated = _mm256_or_ps(
+            _mm256_cmp_ps(boxMin[0], load2x4(t.maxX, low, high), _CMP_GT_OQ),
+            _mm256_cmp_ps(boxMax[0], load2x4(t.minX, low, high), _CMP_LT_OQ));
+        separated = _mm256_or_ps(separated, _mm256_or_ps(
+            _mm256_cmp_ps(boxMin[1], load2x4(t.maxY, low, high), _CMP_GT_OQ),
+            _mm256_cmp_ps(boxMax[1], load2x4(t.minY, low, high), _CMP_LT_OQ)));
+        separated = _mm256_or_ps(separated, _mm256_or_ps(
+            _mm256_cmp_ps(boxMin[2], load2x4(t.maxZ, low, high), _CMP_GT_OQ),
+            _mm256_cmp_ps(boxMax[2], load2x4(t.minZ, low, high), _CMP_LT_OQ)));
+
+        // Most candidates fail on their bounds; skip the remaining loads when all lanes did
+        if (_mm256_movemask_ps(separated) == 0xFF) {
+            return 0;
+        }
+
+        // 2. Triangle normal
+        __m256 nx = load2x4(t.nx, low, high);
+        __m256 ny = load2x4(t.ny, low, high);
+        __m256 nz = load2x4(t.nz, low, high);
+        __m256 distance = _mm256_sub_ps(
+            _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, c[0]), _mm256_mul_ps(ny, c[1])), _mm256_mul_ps(nz, c[2])),
+            load2x4(t.nd, low, high));
+        __m256 radius = _mm256_add_ps(_mm256_add_ps(
+            _mm256_mul_ps(h[0], _mm256_andnot_ps(signMask, nx)),
+            _mm256_mul_ps(h[1], _mm256_andnot_ps(signMask, ny))),
+            _mm256_mul_ps(h[2], _mm256_andnot_ps(signMask, nz)));
+        separated = _mm256_or_ps(separated, _mm256_cmp_ps(_mm256_andnot_ps(signMask, distance), radius, _CMP_GT_OQ));
+        if (_mm256_movemask_ps(separated) == 0xFF) {
+            return 0;
+        }
+
+        // 3. Edge cross products
+        for (int axis = 0; axis < CollisionTriangleSoA::CROSS_AXIS_COUNT; axis++) {
+            int a = CROSS_COMPONENT_A[axis % 3];
+            int b = CROSS_COMPONENT_B[axis % 3];
+            __m256 axisA = load2x4(t.crossA[axis], low, high);
+            __m256 axisB = load2x4(t.crossB[axis], low, high);
+            __m256 center = _mm256_add_ps(_mm256_mul_ps(axisA, c[a]), _mm256_mul_ps(axisB, c[b]));
+            __m256 boxRadius = _mm256_add_ps(
+                _mm256_mul_ps(h[a], _mm256_andnot_ps(signMask, axisA)),
+                _mm256_mul_ps(h[b], _mm256_andnot_ps(signMask, axisB)));
+            separated = _mm256_or_ps(separated, _mm256_or_ps(
+                _mm256_cmp_ps(_mm256_sub_ps(center, boxRadius), load2x4(t.crossMax[axis], low, high), _CMP_GT_OQ),
+                _mm256_cmp_ps(_mm256_add_ps(center, boxRadius), load2x4(t.crossMin[axis], low, high), _CMP_LT_OQ)));
+        }
+
+        return ~_mm256_movemask_ps(separated) & 0xFF;
+    }
+
+    COLLISION_TARGET_AVX2
+    void overlapBoxAVX2(const CollisionTriangleSoA& triangles, const std::vector<TriangleRange>& ranges,
+        const glm::vec3& boxCenter, const glm::vec3& boxHalfExtents, std::vector<uint32_t>& hits) {
+        const __m256 c[3] = { _mm256_set1_ps(boxCenter.x), _mm256_set1_ps(boxCenter.y), _mm256_set1_ps(boxCenter.z) };
+        const __m256 h[3] = { _mm256_set1_ps(boxHalfExtents.x), _mm256_set1_ps(boxHalfExtents.y), _mm256_set1_ps(boxHalfExtents.z) };
+
+        // Ranges are cut into chunks of up to 4 and tested two chunks per iteration,
+        // so a query touching many small leaves still fills all 8 lanes
+        uint32_t pending[2] = {};
+        uint32_t pendingLanes[2] = {};
+        int pendingCount = 0;
+
+        size_t rangeIndex = 0;
+        uint32_t next = ranges.empty() ? 0 : ranges[0].first;
+        while (rangeIndex < ranges.size() || pendingCount > 0) {
+            // Take the next chunk, skipping empty ranges
+            while (rangeIndex < ranges.size() && next >= ranges[rangeIndex].first + ranges[rangeIndex].count) {
+                rangeIndex++;
+                next = rangeIndex < ranges.size() ? ranges[rangeIndex].first : 0;
+            }
+            bool hasChunk = rangeIndex < ranges.size();
+            if (hasChunk) {
+                pending[pendingCount] = next;
+                pendingLanes[pendingCount] = std::min(4u, ranges[rangeIndex].first + ranges[rangeIndex].count - next);
+                pendingCount++;
+                next += 4;
+            }
+            if (pendingCount == 0) {
+                break;
+            }
+            if (pendingCount < 2 && hasChunk) {
+                continue;
+            }
+
+            // An unpaired last chunk is tested against itself with the upper lanes masked off
+            uint32_t high = pendingCount == 2 ? pending[1] : pending[0];
+            uint32_t highLanes = pendingCount == 2 ? pendingLanes[1] : 0;
+            int laneMask = ((1 << pendingLanes[0]) - 1) | (((1 << highLanes) - 1) << 4);
+            int mask = overlapMaskAVX2(triangles, pending[0], high, c, h) & laneMask;
+            while (mask) {
+                int lane = 0;
+                while (!(mask & (1 << lane))) lane++;
+                hits.push_back(lane < 4 ? pending[0] + lane : high + lane - 4);
+                mask &= mask - 1;
+            }
+            pendingCount = 0;
+        }
+    }
+#endif
+}
+
+SATKernel::Level SATKernel::getSupportedLevel() {
+    static const Level supported = detectSupportedLevel();
+    return supported;
+}
+
+SATKernel::Level SATKernel::getLevel() {
+    return activeLevel().load(std::memory_order_relaxed);
+}
+
+void SATKernel::setLevel(Level level) {
+    activeLevel().store(std::min(level, getSupportedLevel()), std::memory_order_relaxed);
+}
+
+const char* SATKernel::getLevelName(Level level) {
+    switch (level) {
+    case Level::SSE: return "sse";
+    case Level::AVX2: return "avx2";
+    default: return "scalar";
+    }
+}
+
+void SATKernel::overlapBox(const CollisionTriangleSoA& triangles, const std::vector<TriangleRange>& ranges,
+    const glm::vec3& boxCenter, const glm::vec3& boxHalfExtents, std::vector<uint32_t>& hits) {
+    switch (getLevel()) {
+#ifdef COLLISION_SIMD_X86
+    case Level::AVX2:
+        overlapBoxAVX2(triangles, ranges, boxCenter, boxHalfExtents, hits);
+        break;
+    case Level::SSE:
+        overlapBoxSSE(triangles, ranges, boxCenter, boxHalfExtents, hits);
+        break;
+#endif
+    default:
+        overlapBoxScalar(triangles, ranges, boxCenter, boxHalfExtents, hits);
+        break;
+    }
+}
+
+bool SATKernel::sweepBox(const CollisionTriangleSoA& triangles, const std::vector<TriangleRange>& ranges,
+    const glm::vec3& boxCenter, const glm::vec3& boxHalfExtents, const glm::vec3& displacement, SweepHit& hit) {
+    // Scalar only: a sweep tests the few leaves along one path, which the 13 axis loop handles
+    // well enough without a wide version
+    bool found = false;
+    for (const TriangleRange& range : ranges) {
+        for (uint32_t i = range.first; i < range.first + range.count; i++) {
+            SweepInterval interval;
+            if (!sweepScalar(triangles, i, boxCenter, boxHalfExtents, displacement, interval) || interval.enter >= hit.time) {
+                continue;
+            }
+            hit.time = interval.enter;
+            hit.normal = interval.normal;
+            hit.triangle = i;
+            found = true;
+        }
+    }
+    return found;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "collision_triangle.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// Earliest contact of a box sweep
+struct SweepHit {
+    float time = 1.0f;                    // Fraction of the displacement travelled before contact
+    glm::vec3 normal = glm::vec3(0.0f);   // Separating axis at contact, pointing from the triangle towards the box
+    uint32_t triangle = 0;
+};
+
+// Separating axis test of one axis-aligned box against many triangles at once.
+// Axes are the 3 box faces, the triangle normal and the 9 edge cross products. The
+// triangle side of every test is precomputed in CollisionTriangleSoA, so the kernel
+// only projects the box onto each axis and compares.
+class SATKernel {
+public:
+    enum class Level {
+        Scalar,
+        SSE,   // 4 triangles per iteration
+        AVX2,  // 8 triangles per iteration
+    };
+
+    // Best level this CPU supports, detected once
+    static Level getSupportedLevel();
+    // Level used by overlapBox; defaults to the supported one. Requests above it are clamped.
+    static Level getLevel();
+    static void setLevel(Level level);
+    static const char* getLevelName(Level level);
+
+    // Appends to hits the index of every triangle in ranges that overlaps the box
+    static void overlapBox(const CollisionTriangleSoA& triangles, const std::vector<TriangleRange>& ranges,
+        const glm::vec3& boxCenter, const glm::vec3& boxHalfExtents, std::vector<uint32_t>& hits);
+
+    // Moving-box variant of the same 13 axes: finds the time of impact of the box moving by
+    // displacement against every triangle in ranges. Only contacts earlier than hit.time replace
+    // hit, so one SweepHit can collect the earliest contact across several calls. Triangles the
+    // box already overlaps at the start are skipped; they are left to the overlap test.
+    static bool sweepBox(const CollisionTriangleSoA& triangles, const std::vector<TriangleRange>& ranges,
+        const glm::vec3& boxCenter, const glm::vec3& boxHalfExtents, const glm::vec3& displacement, SweepHit& hit);
+};
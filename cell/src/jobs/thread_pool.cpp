@@ -0,0 +1,102 @@
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <latch>
+#include <memory>
+
+ThreadPool::ThreadPool(size_t threadCount)
+    : m_Stopping(false)
+{
+    threadCount = std::max<size_t>(threadCount, 1);
+    m_Workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++) {
+        m_Workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stopping = true;
+        // Tasks that never started are dropped; running ones finish before join
+        m_Tasks.clear();
+    }
+    m_Condition.notify_all();
+
+    for (auto& worker : m_Workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Tasks.push_back(std::move(task));
+    }
+    m_Condition.notify_one();
+}
+
+size_t ThreadPool::getChunkCount(size_t count, size_t minChunkSize) const {
+    minChunkSize = std::max<size_t>(minChunkSize, 1);
+    size_t chunksByWork = (count + minChunkSize - 1) / minChunkSize;
+    return std::min(chunksByWork, m_Workers.size() + 1);
+}
+
+void ThreadPool::parallelFor(size_t count, size_t minChunkSize, const std::function<void(size_t, size_t, size_t)>& body) {
+    size_t chunkCount = getChunkCount(count, minChunkSize);
+    if (chunkCount == 0) {
+        return;
+    }
+
+    // Chunk c covers [c * count / chunkCount, (c + 1) * count / chunkCount). Claims are shared,
+    // not on the stack: a task that starts after the caller returned still finds every chunk
+    // claimed and never dereferences body.
+    struct Claims {
+        std::atomic<size_t> nextChunk{ 0 };
+        std::latch remaining;
+        explicit Claims(size_t chunkCount) : remaining(static_cast<std::ptrdiff_t>(chunkCount)) {}
+    };
+    auto claims = std::make_shared<Claims>(chunkCount);
+    const auto* bodyPointer = &body;
+
+    auto runChunks = [claims, bodyPointer, count, chunkCount]() {
+        size_t chunk;
+        while ((chunk = claims->nextChunk.fetch_add(1)) < chunkCount) {
+            (*bodyPointer)(chunk * count / chunkCount, (chunk + 1) * count / chunkCount, chunk);
+            claims->remaining.count_down();
+        }
+    };
+
+    for (size_t task = 1; task < chunkCount; task++) {
+        submit(runChunks);
+    }
+
+    runChunks();
+    claims->remaining.wait();
+}
+
+size_t ThreadPool::getDefaultThreadCount() {
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+}
+
+ThreadPool& ThreadPool::getShared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Condition.wait(lock, [this]() { return m_Stopping || !m_Tasks.empty(); });
+            if (m_Stopping) {
+                return;
+            }
+            task = std::move(m_Tasks.front());
+            m_Tasks.pop_front();
+        }
+        task();
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Fixed set of worker threads pulling tasks from a shared FIFO queue
+class ThreadPool {
+private:
+    std::vector<std::thread> m_Workers;
+    std::deque<std::function<void()>> m_Tasks;
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    bool m_Stopping;
+
+    void workerLoop();
+
+public:
+    explicit ThreadPool(size_t threadCount = getDefaultThreadCount());
+    ~ThreadPool();
+
+    // Prevent copying since workers capture this pool
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queues a task; it runs on whichever worker frees up first
+    void submit(std::function<void()> task);
+
+    // Splits [0, count) into contiguous chunks of at least minChunkSize, at most one per worker
+    // plus one for the caller, and runs body(begin, end, chunk) on each. Chunk boundaries only
+    // depend on count, so per-chunk output merged in chunk order is deterministic. Chunks go to
+    // whichever thread claims them first, the caller included, so the caller only ever waits on
+    // chunks already running: busy workers never stall it, and it is safe to call from a task.
+    void parallelFor(size_t count, size_t minChunkSize, const std::function<void(size_t, size_t, size_t)>& body);
+    // Number of chunks parallelFor will use for these arguments
+    size_t getChunkCount(size_t count, size_t minChunkSize) const;
+
+    size_t getThreadCount() const { return m_Workers.size(); }
+
+    // One worker per hardware thread, leaving one for the render thread
+    static size_t getDefaultThreadCount();
+
+    // The process-wide job pool. Model loading, image decoding and collision all run on it,
+    // so together they never use more threads than the machine has.
+    static ThreadPool& getShared();
+};
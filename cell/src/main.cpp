@@ -4,11 +4,15 @@
 #include <GLFW/glfw3.h>
 #include "window/window.h"
 #include "shaderfv/shader.h"
+#include "shaderfv/frame_uniforms.h"
 #include "ui/ui.h"
 #include "model/model_manager.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "camera.h"
+#include "frustum.h"
+#include "render_queue.h"
+#include "gl_state.h"
 #include "skybox/skybox.h"
 #include "scene.h"
 #include "player_controller.h"
@@ -25,7 +29,8 @@ int main() {
         return -1;
     }
 
-    glEnable(GL_DEPTH_TEST);
+    GLState::setDepthTest(true);
+    GLState::setDepthFunc(GL_LESS);
 
     Shader shader;
     if (!shader.init("src/shaders/vertex.glsl", "src/shaders/fragment.glsl")) {
@@ -42,6 +47,12 @@ int main() {
         return -1;
     }
 
+    FrameUniforms frameUniforms;
+    if (!frameUniforms.init()) {
+        std::cerr << "Failed to create frame uniform buffer" << std::endl;
+        return -1;
+    }
+
     Skybox skybox;
     if (!skybox.init()) {  // Uses default texture directory
         std::cerr << "Failed to initialize skybox" << std::endl;
@@ -54,6 +65,10 @@ int main() {
     }
 
     ModelManager modelManager;
+    ui.setModelManager(&modelManager);
+
+    RenderQueue renderQueue;
+    ui.setRenderQueue(&renderQueue);
 
     Scene scene(&modelManager, &ui);
     ui.setSaveSceneCallback([&scene]() {
@@ -67,9 +82,10 @@ int main() {
 
     // Create view and projection matrices
     glm::mat4 view = glm::lookAt(cameraPos, cameraTarget, cameraUp);
+    const float FAR_PLANE = 800.0f;
     glm::mat4 projection = glm::perspective(glm::radians(60.0f),
         static_cast<float>(window.getWidth()) / window.getHeight(),
-        0.1f, 800.0f);
+        0.1f, FAR_PLANE);
 
     Camera camera(window.getHandle());
 
@@ -85,31 +101,36 @@ int main() {
         float deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
+        GLState::beginFrame();
+
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
         camera.update(deltaTime);
+        glm::mat4 viewMatrix = camera.getViewMatrix();
 
-        shader.use();
-        shader.setInt("diffuseTexture", 0);
+        // One upload serves every program that declares the FrameData block
+        frameUniforms.update(viewMatrix, projection, camera.getPosition(), currentFrame);
 
-        shader.setMat4("view", camera.getViewMatrix());
-        shader.setMat4("projection", projection);
+        // Culled against the same matrices the frame is drawn with
+        Frustum frustum;
+        frustum.extract(projection * viewMatrix);
+
+        shader.use();
+        shader.setInt("diffuseTexture"_uniform, 0);
 
-        modelManager.updateModelsFromSelection(ui.getSelectedModels());
-        modelManager.renderAll(shader);
+        modelManager.syncSelection(ui.getSelectedModels(), ui.getSelectionGeneration());
+        modelManager.processCompletedLoads();
+        renderQueue.begin(viewMatrix, FAR_PLANE);
+        modelManager.submitVisible(renderQueue, shader, frustum);
+        renderQueue.execute();
 
         skyboxShader.use();
-        glm::mat4 skyboxView = glm::mat4(glm::mat3(camera.getViewMatrix()));
-        skyboxShader.setMat4("view", skyboxView);
-        skyboxShader.setMat4("projection", projection);
-        skyboxShader.setInt("skybox", 0); 
+        skyboxShader.setInt("skybox"_uniform, 0); 
         skybox.render(skyboxShader);
 
         if (!ui.isPlayerMode()) {
             wireframeShader.use();
-            wireframeShader.setMat4("view", camera.getViewMatrix());
-            wireframeShader.setMat4("projection", projection);
             player.renderAABB(wireframeShader);
         }
 
@@ -1,18 +1,14 @@
 #include "material.h"
+#include "texture_cache.h"
 
 bool Material::loadDiffuseTexture(const std::string& path) {
-    m_DiffuseTexture = std::make_shared<Texture>();
-    return m_DiffuseTexture->loadTexture(path);
+    // Shared with every other material that uses the same image
+    m_DiffuseTexture = TextureCache::get().acquire(path);
+    return m_DiffuseTexture != nullptr;
 }
 
-void Material::bind() const {
+void Material::uploadTextures() {
     if (m_DiffuseTexture) {
-        m_DiffuseTexture->bind(0); // unit 0 for diffuse
+        m_DiffuseTexture->uploadToGPU();
     }
 }
-
-void Material::unbind() const {
-    if (m_DiffuseTexture) {
-        m_DiffuseTexture->unbind();
-    }
-}
\ No newline at end of file
@@ -28,9 +28,10 @@ public:
     Material(const Material&) = delete;
     Material& operator=(const Material&) = delete;
 
+    // Decodes the texture only; call uploadTextures on the render thread before drawing
     bool loadDiffuseTexture(const std::string& path);
-    void bind() const;
-    void unbind() const;
+    void setDiffuseTexture(std::shared_ptr<Texture> texture) { m_DiffuseTexture = std::move(texture); }
+    void uploadTextures();
 
     const std::string& getName() const { return m_Name; }
     std::shared_ptr<Texture> getDiffuseTexture() const { return m_DiffuseTexture; }
@@ -0,0 +1,579 @@
+#include "mesh_cache.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <cstring>
+#include <limits>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const char MESH_CACHE_MAGIC[4] = { 'C', 'M', 'S', 'H' };
+
+    // Size recorded for a referenced source that did not exist at cook time
+    constexpr uint64_t MISSING_SOURCE_SIZE = std::numeric_limits<uint64_t>::max();
+
+    // Identity of a source file at cook time
+    struct SourceStamp {
+        std::string path;
+        int64_t timestamp = 0;
+        uint64_t size = 0;
+        uint64_t hash = 0;
+    };
+
+    uint64_t hashBytes(const char* data, size_t size) {
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < size; i++) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    bool readWholeFile(const std::string& path, std::string& contents) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        std::ostringstream stream;
+        stream << file.rdbuf();
+        contents = stream.str();
+        return true;
+    }
+
+    bool stampFile(const std::string& path, SourceStamp& stamp, bool withHash) {
+        std::error_code ec;
+        auto writeTime = std::filesystem::last_write_time(path, ec);
+        if (ec) return false;
+        auto size = std::filesystem::file_size(path, ec);
+        if (ec) return false;
+
+        stamp.path = path;
+        stamp.timestamp = static_cast<int64_t>(writeTime.time_since_epoch().count());
+        stamp.size = static_cast<uint64_t>(size);
+
+        if (withHash) {
+            std::string contents;
+            if (!readWholeFile(path, contents)) return false;
+            stamp.hash = hashBytes(contents.data(), contents.size());
+        }
+        return true;
+    }
+
+    // Collects the .mtl libraries referenced by "mtllib" lines of an .obj
+    std::vector<std::string> findMaterialLibraries(const std::string& objPath) {
+        std::vector<std::string> libraries;
+        std::ifstream file(objPath);
+        std::filesystem::path baseDir = std::filesystem::path(objPath).parent_path();
+
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.compare(0, 6, "mtllib") != 0) continue;
+            std::istringstream tokens(line.substr(6));
+            std::string name;
+            while (tokens >> name) {
+                libraries.push_back((baseDir / name).string());
+            }
+        }
+        return libraries;
+    }
+
+    // A stamp is still valid if the file looks untouched, or if it was touched but its content is
+    // unchanged; in that case restamp is set to the timestamp the cache should record instead
+    bool isStampValid(const SourceStamp& cooked, bool& restamp, int64_t& currentTimestamp) {
+        restamp = false;
+        if (cooked.size == MISSING_SOURCE_SIZE) {
+            std::error_code ec;
+            return !std::filesystem::exists(cooked.path, ec);
+        }
+
+        SourceStamp current;
+        if (!stampFile(cooked.path, current, false)) return false;
+        if (current.size != cooked.size) return false;
+        if (current.timestamp == cooked.timestamp) return true;
+
+        if (!stampFile(cooked.path, current, true)) return false;
+        if (current.hash != cooked.hash) return false;
+        restamp = true;
+        currentTimestamp = current.timestamp;
+        return true;
+    }
+
+    // Overwrites recorded timestamps in place; each is at a byte offset in the cache file
+    void rewriteTimestamps(const std::string& cachePath, const std::vector<std::pair<size_t, int64_t>>& timestamps) {
+        std::fstream file(cachePath, std::ios::binary | std::ios::in | std::ios::out);
+        if (!file.is_open()) {
+            return;
+        }
+        for (const auto& [offset, timestamp] : timestamps) {
+            file.seekp(static_cast<std::streamoff>(offset));
+            file.write(reinterpret_cast<const char*>(&timestamp), sizeof(timestamp));
+        }
+    }
+
+    // Whole triangles whose indices all name an existing vertex
+    bool areIndicesValid(const void* indices, size_t indexCount, size_t indexSize, size_t vertexCount) {
+        if (indexCount % 3 != 0) {
+            return false;
+        }
+        for (size_t i = 0; i < indexCount; i++) {
+            size_t index = indexSize == sizeof(uint16_t)
+                ? static_cast<const uint16_t*>(indices)[i]
+                : static_cast<const uint32_t*>(indices)[i];
+            if (index >= vertexCount) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    class BinaryWriter {
+    private:
+        std::ofstream& m_Stream;
+
+    public:
+        explicit BinaryWriter(std::ofstream& stream) : m_Stream(stream) {}
+
+        template <typename T>
+        void write(const T& value) {
+            m_Stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        void writeString(const std::string& value) {
+            write(static_cast<uint32_t>(value.size()));
+            m_Stream.write(value.data(), value.size());
+        }
+
+        template <typename T>
+        void writeArray(const std::vector<T>& values) {
+            m_Stream.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+        }
+
+        void writeBytes(const void* data, size_t size) {
+            m_Stream.write(static_cast<const char*>(data), size);
+        }
+
+        void align(size_t alignment) {
+            static const char padding[8] = {};
+            size_t offset = static_cast<size_t>(m_Stream.tellp());
+            size_t remainder = offset % alignment;
+            if (remainder != 0) {
+                m_Stream.write(padding, alignment - remainder);
+            }
+        }
+    };
+
+    // Bounds-checked cursor over the mapped cache file
+    class BinaryReader {
+    private:
+        const unsigned char* m_Data;
+        size_t m_Size;
+        size_t m_Offset;
+        bool m_Failed;
+
+    public:
+        BinaryReader(const unsigned char* data, size_t size)
+            : m_Data(data), m_Size(size), m_Offset(0), m_Failed(false) {}
+
+        bool failed() const { return m_Failed; }
+        size_t getOffset() const { return m_Offset; }
+
+        // Continues at the same offset in a remapping of the same file
+        void rebase(const unsigned char* data, size_t size) {
+            m_Data = data;
+            m_Size = size;
+            if (!data || m_Offset > size) {
+                m_Failed = true;
+            }
+        }
+
+        const unsigned char* take(size_t bytes) {
+            if (m_Failed || m_Size - m_Offset < bytes) {
+                m_Failed = true;
+                return nullptr;
+            }
+            const unsigned char* ptr = m_Data + m_Offset;
+            m_Offset += bytes;
+            return ptr;
+        }
+
+        template <typename T>
+        T read() {
+            T value{};
+            if (const unsigned char* ptr = take(sizeof(T))) {
+                std::memcpy(&value, ptr, sizeof(T));
+            }
+            return value;
+        }
+
+        std::string readString() {
+            uint32_t length = read<uint32_t>();
+            const unsigned char* ptr = take(length);
+            return ptr ? std::string(reinterpret_cast<const char*>(ptr), length) : std::string();
+        }
+
+        // Pointer to count elements in the mapping; nothing is copied
+        const unsigned char* takeArray(size_t count, size_t elementSize) {
+            if (m_Failed || count > (m_Size - m_Offset) / elementSize) {
+                m_Failed = true;
+                return nullptr;
+            }
+            return take(count * elementSize);
+        }
+
+        // Bulk copy out of the mapping, for the arrays that are not uploaded as they are
+        template <typename T>
+        void readArray(std::vector<T>& values, size_t count) {
+            values.clear();
+            if (count == 0) {
+                return;
+            }
+            if (const unsigned char* ptr = takeArray(count, sizeof(T))) {
+                values.resize(count);
+                std::memcpy(values.data(), ptr, count * sizeof(T));
+            }
+        }
+
+        void align(size_t alignment) {
+            size_t remainder = m_Offset % alignment;
+            if (remainder != 0) {
+                take(alignment - remainder);
+            }
+        }
+    };
+}
+
+MappedFile::MappedFile()
+    : m_Data(nullptr)
+    , m_Size(0)
+#ifdef _WIN32
+    , m_FileHandle(nullptr)
+    , m_MappingHandle(nullptr)
+#else
+    , m_FileDescriptor(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    m_FileHandle = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        close();
+        return false;
+    }
+    m_Size = static_cast<size_t>(fileSize.QuadPart);
+
+    m_MappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_MappingHandle) {
+        close();
+        return false;
+    }
+
+    m_Data = static_cast<const unsigned char*>(MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0));
+#else
+    m_FileDescriptor = ::open(path.c_str(), O_RDONLY);
+    if (m_FileDescriptor < 0) {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(m_FileDescriptor, &fileStat) != 0 || fileStat.st_size == 0) {
+        close();
+        return false;
+    }
+    m_Size = static_cast<size_t>(fileStat.st_size);
+
+    void* mapping = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, m_FileDescriptor, 0);
+    m_Data = mapping == MAP_FAILED ? nullptr : static_cast<const unsigned char*>(mapping);
+#endif
+
+    if (!m_Data) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+    if (m_Data) {
+        UnmapViewOfFile(m_Data);
+    }
+    if (m_MappingHandle) {
+        CloseHandle(m_MappingHandle);
+        m_MappingHandle = nullptr;
+    }
+    if (m_FileHandle) {
+        CloseHandle(m_FileHandle);
+        m_FileHandle = nullptr;
+    }
+#else
+    if (m_Data) {
+        munmap(const_cast<unsigned char*>(m_Data), m_Size);
+    }
+    if (m_FileDescriptor >= 0) {
+        ::close(m_FileDescriptor);
+        m_FileDescriptor = -1;
+    }
+#endif
+    m_Data = nullptr;
+    m_Size = 0;
+}
+
+void MeshBufferView::copyPositions(std::vector<float>& positions, std::vector<unsigned int>& wideIndices) const {
+    size_t vertexCount = vertexFloatCount / VERTEX_STRIDE;
+    positions.resize(vertexCount * 3);
+    for (size_t i = 0; i < vertexCount; i++) {
+        std::memcpy(&positions[i * 3], &vertices[i * VERTEX_STRIDE], 3 * sizeof(float));
+    }
+
+    wideIndices.resize(indexCount);
+    if (indexSize == sizeof(uint16_t)) {
+        const uint16_t* shortIndices = static_cast<const uint16_t*>(indices);
+        std::copy(shortIndices, shortIndices + indexCount, wideIndices.begin());
+    }
+    else if (indexCount > 0) {
+        std::memcpy(wideIndices.data(), indices, indexCount * sizeof(uint32_t));
+    }
+}
+
+bool MeshCache::fitsShortIndices(size_t vertexCount) {
+    return vertexCount <= static_cast<size_t>(std::numeric_limits<uint16_t>::max()) + 1;
+}
+
+void MeshCache::prepareBuffers(CookedMeshData& data) {
+    data.buffers = MeshBufferView();
+    data.buffers.vertices = data.vertices.data();
+    data.buffers.vertexFloatCount = data.vertices.size();
+    data.buffers.indexCount = data.indices.size();
+
+    if (fitsShortIndices(data.vertices.size() / MeshBufferView::VERTEX_STRIDE)) {
+        data.shortIndices.assign(data.indices.begin(), data.indices.end());
+        data.buffers.indices = data.shortIndices.data();
+        data.buffers.indexSize = sizeof(uint16_t);
+    }
+    else {
+        data.shortIndices.clear();
+        data.buffers.indices = data.indices.data();
+        data.buffers.indexSize = sizeof(uint32_t);
+    }
+}
+
+std::string MeshCache::getCachePath(const std::string& objPath) {
+    return std::filesystem::path(objPath).replace_extension(".cmesh").string();
+}
+
+bool MeshCache::write(const std::string& objPath, const CookedMeshData& data) {
+    // Stamp the .obj and every .mtl it pulls in
+    std::vector<SourceStamp> sources(1);
+    if (!stampFile(objPath, sources[0], true)) {
+        return false;
+    }
+    for (const auto& library : findMaterialLibraries(objPath)) {
+        SourceStamp stamp;
+        if (!stampFile(library, stamp, true)) {
+            // Still recorded, so the cache goes stale once the library appears
+            stamp = SourceStamp();
+            stamp.path = library;
+            stamp.size = MISSING_SOURCE_SIZE;
+        }
+        sources.push_back(stamp);
+    }
+
+    // Write to a temporary file first so a crash never leaves a truncated cache behind
+    std::string cachePath = getCachePath(objPath);
+    std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open mesh cache for writing: " << tempPath << std::endl;
+            return false;
+        }
+
+        BinaryWriter writer(file);
+        file.write(MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC));
+        writer.write(VERSION);
+        writer.write(static_cast<uint32_t>(sources.size()));
+        writer.write(static_cast<uint32_t>(data.materials.size()));
+        writer.write(static_cast<uint32_t>(data.buffers.vertexFloatCount));
+        writer.write(static_cast<uint32_t>(data.buffers.indexCount));
+        writer.write(data.buffers.indexSize);
+        writer.write(static_cast<uint32_t>(data.materialIndices.size()));
+        writer.write(static_cast<uint32_t>(data.collisionVertices.size()));
+        writer.write(static_cast<uint32_t>(data.collisionIndices.size()));
+        writer.write(data.boundsMin);
+        writer.write(data.boundsMax);
+        writer.write(data.boundsRadius);
+
+        for (const auto& source : sources) {
+            writer.writeString(source.path);
+            writer.write(source.timestamp);
+            writer.write(source.size);
+            writer.write(source.hash);
+        }
+
+        for (const auto& material : data.materials) {
+            writer.writeString(material.name);
+            writer.writeString(material.diffuseTexname);
+            writer.write(material.ambient);
+            writer.write(material.diffuse);
+            writer.write(material.shininess);
+        }
+
+        writer.align(sizeof(float));
+        writer.writeBytes(data.buffers.vertices, data.buffers.getVertexBytes());
+        writer.writeBytes(data.buffers.indices, data.buffers.getIndexBytes());
+        writer.align(sizeof(uint32_t));
+        writer.writeArray(data.materialIndices);
+        writer.writeArray(data.collisionVertices);
+        writer.writeArray(data.collisionIndices);
+
+        if (!file.good()) {
+            std::cerr << "Failed to write mesh cache: " << tempPath << std::endl;
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, cachePath, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+bool MeshCache::read(const std::string& objPath, CookedMeshData& data) {
+    std::string cachePath = getCachePath(objPath);
+    auto file = std::make_unique<MappedFile>();
+    if (!file->open(cachePath)) {
+        return false;
+    }
+
+    BinaryReader reader(file->data(), file->size());
+    const unsigned char* magic = reader.take(sizeof(MESH_CACHE_MAGIC));
+    if (!magic || std::memcmp(magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC)) != 0) {
+        return false;
+    }
+    if (reader.read<uint32_t>() != VERSION) {
+        return false;
+    }
+
+    uint32_t sourceCount = reader.read<uint32_t>();
+    uint32_t materialCount = reader.read<uint32_t>();
+    uint32_t vertexFloatCount = reader.read<uint32_t>();
+    uint32_t indexCount = reader.read<uint32_t>();
+    uint32_t indexSize = reader.read<uint32_t>();
+    uint32_t materialIndexCount = reader.read<uint32_t>();
+    uint32_t collisionVertexFloatCount = reader.read<uint32_t>();
+    uint32_t collisionIndexCount = reader.read<uint32_t>();
+    data.boundsMin = reader.read<glm::vec3>();
+    data.boundsMax = reader.read<glm::vec3>();
+    data.boundsRadius = reader.read<float>();
+
+    if (indexSize != sizeof(uint16_t) && indexSize != sizeof(uint32_t)) {
+        return false;
+    }
+
+    // Reject the cache as soon as any source changed
+    std::vector<std::pair<size_t, int64_t>> restamps;
+    for (uint32_t i = 0; i < sourceCount && !reader.failed(); i++) {
+        SourceStamp stamp;
+        stamp.path = reader.readString();
+        size_t timestampOffset = reader.getOffset();
+        stamp.timestamp = reader.read<int64_t>();
+        stamp.size = reader.read<uint64_t>();
+        stamp.hash = reader.read<uint64_t>();
+
+        bool restamp = false;
+        int64_t currentTimestamp = 0;
+        if (reader.failed() || !isStampValid(stamp, restamp, currentTimestamp)) {
+            return false;
+        }
+        if (restamp) {
+            restamps.push_back({ timestampOffset, currentTimestamp });
+        }
+    }
+
+    // Touched but unchanged sources get their new timestamp, so the next launch skips the hashing.
+    // The mapping is closed first: Windows refuses to write a file that is mapped.
+    if (!restamps.empty()) {
+        file->close();
+        rewriteTimestamps(cachePath, restamps);
+        if (!file->open(cachePath)) {
+            return false;
+        }
+        reader.rebase(file->data(), file->size());
+    }
+
+    data.materials.clear();
+    for (uint32_t i = 0; i < materialCount && !reader.failed(); i++) {
+        CookedMaterial material;
+        material.name = reader.readString();
+        material.diffuseTexname = reader.readString();
+        material.ambient = reader.read<glm::vec3>();
+        material.diffuse = reader.read<glm::vec3>();
+        material.shininess = reader.read<float>();
+        data.materials.push_back(material);
+    }
+
+    // The render arrays stay where they are; the GPU upload reads them from the mapping
+    reader.align(sizeof(float));
+    data.vertices.clear();
+    data.indices.clear();
+    data.shortIndices.clear();
+    data.buffers = MeshBufferView();
+    data.buffers.vertices = reinterpret_cast<const float*>(reader.takeArray(vertexFloatCount, sizeof(float)));
+    data.buffers.vertexFloatCount = vertexFloatCount;
+    data.buffers.indices = reader.takeArray(indexCount, indexSize);
+    data.buffers.indexCount = indexCount;
+    data.buffers.indexSize = indexSize;
+    reader.align(sizeof(uint32_t));
+
+    // Small, or only needed for the collision build: copied out
+    reader.readArray(data.materialIndices, materialIndexCount);
+    reader.readArray(data.collisionVertices, collisionVertexFloatCount);
+    reader.readArray(data.collisionIndices, collisionIndexCount);
+
+    // A corrupt file would otherwise send the collision build and the draw past the vertex arrays;
+    // rejecting it here parses the .obj instead
+    bool valid = !reader.failed()
+        && vertexFloatCount % MeshBufferView::VERTEX_STRIDE == 0
+        && collisionVertexFloatCount % 3 == 0
+        && areIndicesValid(data.buffers.indices, indexCount, indexSize, vertexFloatCount / MeshBufferView::VERTEX_STRIDE)
+        && areIndicesValid(data.collisionIndices.data(), collisionIndexCount, sizeof(uint32_t), collisionVertexFloatCount / 3);
+    if (!valid) {
+        std::cerr << "Rejecting corrupt mesh cache: " << cachePath << std::endl;
+        data.buffers = MeshBufferView();
+        data.materialIndices.clear();
+        data.collisionVertices.clear();
+        data.collisionIndices.clear();
+        return false;
+    }
+    data.mapping = std::move(file);
+    return true;
+}
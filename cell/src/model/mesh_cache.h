@@ -0,0 +1,108 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Material properties needed to rebuild a Material without re-reading the .mtl
+struct CookedMaterial {
+    std::string name;
+    std::string diffuseTexname;
+    glm::vec3 ambient = glm::vec3(0.1f);
+    glm::vec3 diffuse = glm::vec3(0.8f);
+    float shininess = 32.0f;
+};
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+private:
+    const unsigned char* m_Data;
+    size_t m_Size;
+#ifdef _WIN32
+    void* m_FileHandle;
+    void* m_MappingHandle;
+#else
+    int m_FileDescriptor;
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    const unsigned char* data() const { return m_Data; }
+    size_t size() const { return m_Size; }
+};
+
+// Render arrays in exactly the layout glBufferData takes. Points either into a mapped .cmesh
+// or into the arrays of the CookedMeshData that owns it.
+struct MeshBufferView {
+    static constexpr size_t VERTEX_STRIDE = 8;  // Interleaved: 3 position, 3 normal, 2 texture coordinates
+
+    const float* vertices = nullptr;
+    size_t vertexFloatCount = 0;
+    const void* indices = nullptr;
+    size_t indexCount = 0;
+    uint32_t indexSize = sizeof(uint32_t);  // sizeof(uint16_t) when every vertex fits 16-bit indices
+
+    size_t getVertexBytes() const { return vertexFloatCount * sizeof(float); }
+    size_t getIndexBytes() const { return indexCount * indexSize; }
+
+    // Positions only (stride 3) and widened indices, for building collision from the render mesh
+    void copyPositions(std::vector<float>& positions, std::vector<unsigned int>& wideIndices) const;
+};
+
+// Final processed mesh data
+struct CookedMeshData {
+    // Import output: the welded mesh with 32-bit indices. Empty after MeshCache::read, whose
+    // render arrays stay in the mapping; use buffers for both.
+    std::vector<float> vertices;         // Interleaved: 3 position, 3 normal, 2 texture coordinates
+    std::vector<unsigned int> indices;
+    std::vector<uint16_t> shortIndices;  // indices narrowed by MeshCache::prepareBuffers when they fit
+    std::vector<int> materialIndices;
+    std::vector<CookedMaterial> materials;
+    // Collision proxy, positions only; both empty when collision uses the render mesh
+    std::vector<float> collisionVertices;
+    std::vector<unsigned int> collisionIndices;
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+    float boundsRadius = 0.0f;  // Bounding sphere around the center of the box
+
+    // The mapped .cmesh that buffers points into; null for an imported mesh
+    std::unique_ptr<MappedFile> mapping;
+    // What uploadToGPU hands to glBufferData, as stored in the .cmesh
+    MeshBufferView buffers;
+};
+
+// Versioned binary cache (.cmesh) written next to the source .obj.
+// The cache records the timestamp, size and content hash of the .obj and every
+// .mtl it references; any mismatch invalidates the cooked data. A source that is touched
+// but unchanged gets its timestamp rewritten, and a referenced .mtl that does not exist is
+// recorded as missing so creating it later invalidates the cache.
+// Render indices are stored at their final width, so a read mesh is uploaded as mapped.
+class MeshCache {
+public:
+    static constexpr uint32_t VERSION = 4;
+
+    static bool fitsShortIndices(size_t vertexCount);
+
+    // Narrows data.indices into data.shortIndices when they fit and points data.buffers at
+    // the owned arrays; call once import has filled vertices and indices
+    static void prepareBuffers(CookedMeshData& data);
+
+    // "gamedata/models/floor.obj" -> "gamedata/models/floor.cmesh"
+    static std::string getCachePath(const std::string& objPath);
+
+    // Writes the cooked mesh for objPath from data.buffers; returns false if the file could not be written
+    static bool write(const std::string& objPath, const CookedMeshData& data);
+
+    // Maps the cache for objPath and fills data if it exists and is still valid. The render
+    // arrays are not copied: data.buffers points into data.mapping.
+    static bool read(const std::string& objPath, CookedMeshData& data);
+};
@@ -1,16 +1,69 @@
 #include "model.h"
+#include "gl_state.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
 #include <filesystem>
+#include <unordered_map>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <atomic>
 #include "material.h"
+#include "mesh_cache.h"
+#include "collision_proxy.h"
+#include "texture_cache.h"
+
+namespace {
+    // Interleaved vertex layout: 3 position, 3 normal, 2 texture coordinates
+    constexpr size_t VERTEX_STRIDE = 8;
+
+    // Full vertex attributes used as the welding key
+    struct VertexKey {
+        float data[VERTEX_STRIDE];
+
+        bool operator==(const VertexKey& other) const {
+            return std::memcmp(data, other.data, sizeof(data)) == 0;
+        }
+    };
+
+    // FNV-1a over the raw attribute bits
+    struct VertexKeyHash {
+        size_t operator()(const VertexKey& key) const {
+            uint64_t hash = 14695981039346656037ull;
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(key.data);
+            for (size_t i = 0; i < sizeof(key.data); i++) {
+                hash ^= bytes[i];
+                hash *= 1099511628211ull;
+            }
+            return static_cast<size_t>(hash);
+        }
+    };
+
+    // Models are created on loader threads
+    std::atomic<uint64_t> nextModelID{ 1 };
+}
 
 Model::Model()
     : m_VAO(0)
     , m_VBO(0)
     , m_EBO(0)
+    , m_IndexType(GL_UNSIGNED_INT)
+    , m_IndexCount(0)
     , m_Position(0.0f)
     , m_Rotation(0.0f)
     , m_Scale(1.0f)
+    , m_ModelMatrix(1.0f)
+    , m_NormalMatrix(1.0f)
+    , m_ID(nextModelID++)
+    , m_TransformVersion(0)
+    , m_BoundsMin(0.0f)
+    , m_BoundsMax(0.0f)
+    , m_BoundsRadius(0.0f)
+    , m_WorldCenter(0.0f)
+    , m_WorldHalfExtents(0.0f)
+    , m_WorldRadius(0.0f)
 {
 }
 
@@ -19,14 +72,80 @@ Model::~Model() {
 }
 
 bool Model::loadModel(const std::string& filepath) {
+    if (!loadModelData(filepath)) {
+        return false;
+    }
+
+    uploadToGPU();
+    return true;
+}
+
+bool Model::loadModelData(const std::string& filepath) {
+    std::filesystem::path modelPath(filepath);
+    std::string baseDir = modelPath.parent_path().string() + "/";
+
+    // Prefer the cooked mesh; fall back to parsing the .obj and cooking it for next time
+    // Heap-allocated so the buffer view keeps pointing at the right arrays until upload
+    auto meshData = std::make_unique<CookedMeshData>();
+    if (MeshCache::read(filepath, *meshData)) {
+        std::cout << "Loaded cooked mesh: " << MeshCache::getCachePath(filepath) << std::endl;
+    }
+    else if (!importModel(filepath, baseDir, *meshData)) {
+        return false;
+    }
+
+    m_MaterialIndices = std::move(meshData->materialIndices);
+    m_BoundsMin = meshData->boundsMin;
+    m_BoundsMax = meshData->boundsMax;
+    m_BoundsRadius = meshData->boundsRadius;
+    m_IndexType = meshData->buffers.indexSize == sizeof(uint16_t) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    m_IndexCount = static_cast<GLsizei>(meshData->buffers.indexCount);
+    updateWorldBounds();
+
+    // Built here so the BVH cost stays on the loader thread; from the proxy when import made one.
+    // A mapped mesh without a proxy has only its positions copied out for this.
+    if (!meshData->collisionIndices.empty()) {
+        m_CollisionMesh = CollisionMeshCache::get().acquire(meshData->collisionVertices, 3, meshData->collisionIndices);
+    }
+    else if (!meshData->indices.empty()) {
+        m_CollisionMesh = CollisionMeshCache::get().acquire(meshData->vertices, VERTEX_STRIDE, meshData->indices);
+    }
+    else {
+        std::vector<float> positions;
+        std::vector<unsigned int> indices;
+        meshData->buffers.copyPositions(positions, indices);
+        m_CollisionMesh = CollisionMeshCache::get().acquire(positions, 3, indices);
+    }
+    meshData->collisionVertices = std::vector<float>();
+    meshData->collisionIndices = std::vector<unsigned int>();
+
+    loadMaterialTextures(meshData->materials, baseDir);
+    meshData->materials.clear();
+
+    m_PendingMesh = std::move(meshData);
+    return true;
+}
+
+void Model::uploadToGPU() {
+    if (m_VAO != 0 || !m_PendingMesh) {
+        return;
+    }
+
+    for (const auto& material : m_Materials) {
+        material->uploadTextures();
+    }
+    setupMesh();
+
+    // On the GPU now; unmaps the .cmesh or frees the imported arrays
+    m_PendingMesh.reset();
+}
+
+bool Model::importModel(const std::string& filepath, const std::string& baseDir, CookedMeshData& meshData) {
     tinyobj::attrib_t attrib;
     std::vector<tinyobj::shape_t> shapes;
     std::vector<tinyobj::material_t> materials;
     std::string warn, err;
 
-    std::filesystem::path modelPath(filepath);
-    std::string baseDir = modelPath.parent_path().string() + "/";
-
     // Load the model using tinyobjloader
     bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filepath.c_str(), baseDir.c_str());
 
@@ -44,24 +163,84 @@ bool Model::loadModel(const std::string& filepath) {
         return false;
     }
 
-    loadMaterialTextures(materials, baseDir);
-
     // Process the loaded data into our mesh format
-    processModelData(attrib, shapes, materials);
-    setupMesh();
+    size_t faceCorners = processModelData(attrib, shapes, meshData);
+
+    size_t uniqueVertices = meshData.vertices.size() / VERTEX_STRIDE;
+    float dedupRatio = uniqueVertices > 0 ? static_cast<float>(faceCorners) / uniqueVertices : 0.0f;
+    std::cout << "Welded " << filepath << ": " << faceCorners << " corners -> "
+        << uniqueVertices << " vertices (" << dedupRatio << "x), "
+        << (MeshCache::fitsShortIndices(uniqueVertices) ? "16" : "32") << "-bit indices" << std::endl;
+
+    // Collision tests the authored proxy if the .obj has one, otherwise a simplified render mesh
+    size_t renderTriangles = meshData.indices.size() / 3;
+    if (!meshData.collisionIndices.empty()) {
+        std::cout << "Collision proxy for " << filepath << ": authored, "
+            << meshData.collisionIndices.size() / 3 << " triangles" << std::endl;
+    }
+    else if (CollisionProxy::simplify(meshData.vertices, VERTEX_STRIDE, meshData.indices, CollisionProxy::CLUSTER_SIZE,
+        meshData.collisionVertices, meshData.collisionIndices)) {
+        std::cout << "Collision proxy for " << filepath << ": " << renderTriangles << " -> "
+            << meshData.collisionIndices.size() / 3 << " triangles" << std::endl;
+    }
+
+    // Keep only the material properties we actually use
+    for (const auto& material : materials) {
+        CookedMaterial cooked;
+        cooked.name = material.name;
+        cooked.diffuseTexname = material.diffuse_texname;
+        cooked.ambient = glm::vec3(material.ambient[0], material.ambient[1], material.ambient[2]);
+        cooked.diffuse = glm::vec3(material.diffuse[0], material.diffuse[1], material.diffuse[2]);
+        cooked.shininess = material.shininess;
+        meshData.materials.push_back(cooked);
+    }
+
+    // Indices are narrowed once here, and cooked that way
+    MeshCache::prepareBuffers(meshData);
+    if (!MeshCache::write(filepath, meshData)) {
+        std::cerr << "Failed to write mesh cache for: " << filepath << std::endl;
+    }
 
     return true;
 }
 
-void Model::processModelData(const tinyobj::attrib_t& attrib,
+size_t Model::processModelData(const tinyobj::attrib_t& attrib,
     const std::vector<tinyobj::shape_t>& shapes,
-    const std::vector<tinyobj::material_t>& materials) {
-    // Clear existing data
-    m_Vertices.clear();
-    m_Indices.clear();
+    CookedMeshData& meshData) {
+    std::vector<float>& vertices = meshData.vertices;
+    std::vector<unsigned int>& indices = meshData.indices;
+    vertices.clear();
+    indices.clear();
+    meshData.materialIndices.clear();
+    meshData.collisionVertices.clear();
+    meshData.collisionIndices.clear();
+
+    // Maps each distinct vertex to its slot in vertices
+    std::unordered_map<VertexKey, unsigned int, VertexKeyHash> uniqueVertices;
+    // Same for the collision proxy, keyed on position alone
+    std::unordered_map<VertexKey, unsigned int, VertexKeyHash> uniqueCollisionVertices;
+    size_t faceCorners = 0;
 
     // Process all shapes in the model
     for (const auto& shape : shapes) {
+        // Authored collision shapes are never rendered
+        if (CollisionProxy::isCollisionShapeName(shape.name)) {
+            for (const tinyobj::index_t& idx : shape.mesh.indices) {
+                VertexKey key = {};
+                for (int axis = 0; axis < 3; axis++) {
+                    key.data[axis] = attrib.vertices[3 * idx.vertex_index + axis] + 0.0f;
+                }
+
+                auto [it, inserted] = uniqueCollisionVertices.try_emplace(key,
+                    static_cast<unsigned int>(meshData.collisionVertices.size() / 3));
+                if (inserted) {
+                    meshData.collisionVertices.insert(meshData.collisionVertices.end(), key.data, key.data + 3);
+                }
+                meshData.collisionIndices.push_back(it->second);
+            }
+            continue;
+        }
+
         size_t index_offset = 0;
         for (size_t f = 0; f < shape.mesh.num_face_vertices.size(); f++) {
             int fv = shape.mesh.num_face_vertices[f];
@@ -69,48 +248,84 @@ void Model::processModelData(const tinyobj::attrib_t& attrib,
             if (materialId < 0) materialId = 0;
 
             for (size_t v = 0; v < 3; v++) { // Assuming triangulated faces
-                m_MaterialIndices.push_back(materialId);
+                meshData.materialIndices.push_back(materialId);
             }
 
             // Process all vertices in the face
             for (size_t v = 0; v < fv; v++) {
                 tinyobj::index_t idx = shape.mesh.indices[index_offset + v];
+                VertexKey key;
 
                 // Vertex position
-                m_Vertices.push_back(attrib.vertices[3 * idx.vertex_index + 0]);
-                m_Vertices.push_back(attrib.vertices[3 * idx.vertex_index + 1]);
-                m_Vertices.push_back(attrib.vertices[3 * idx.vertex_index + 2]);
+                key.data[0] = attrib.vertices[3 * idx.vertex_index + 0];
+                key.data[1] = attrib.vertices[3 * idx.vertex_index + 1];
+                key.data[2] = attrib.vertices[3 * idx.vertex_index + 2];
 
                 // Normal
                 if (idx.normal_index >= 0) {
-                    m_Vertices.push_back(attrib.normals[3 * idx.normal_index + 0]);
-                    m_Vertices.push_back(attrib.normals[3 * idx.normal_index + 1]);
-                    m_Vertices.push_back(attrib.normals[3 * idx.normal_index + 2]);
+                    key.data[3] = attrib.normals[3 * idx.normal_index + 0];
+                    key.data[4] = attrib.normals[3 * idx.normal_index + 1];
+                    key.data[5] = attrib.normals[3 * idx.normal_index + 2];
                 }
                 else {
                     // Default normal if none specified
-                    m_Vertices.push_back(0.0f);
-                    m_Vertices.push_back(0.0f);
-                    m_Vertices.push_back(1.0f);
+                    key.data[3] = 0.0f;
+                    key.data[4] = 0.0f;
+                    key.data[5] = 1.0f;
                 }
 
                 // Texture coordinates
                 if (idx.texcoord_index >= 0) {
-                    m_Vertices.push_back(attrib.texcoords[2 * idx.texcoord_index + 0]);
-                    m_Vertices.push_back(attrib.texcoords[2 * idx.texcoord_index + 1]);
+                    key.data[6] = attrib.texcoords[2 * idx.texcoord_index + 0];
+                    key.data[7] = attrib.texcoords[2 * idx.texcoord_index + 1];
                 }
                 else {
                     // Default texture coordinates if none specified
-                    m_Vertices.push_back(0.0f);
-                    m_Vertices.push_back(0.0f);
+                    key.data[6] = 0.0f;
+                    key.data[7] = 0.0f;
+                }
+
+                // Fold -0.0 into 0.0 so both weld to the same vertex
+                for (float& component : key.data) {
+                    component += 0.0f;
+                }
+
+                // Reuse the vertex if an identical one was already emitted
+                auto [it, inserted] = uniqueVertices.try_emplace(key,
+                    static_cast<unsigned int>(vertices.size() / VERTEX_STRIDE));
+                if (inserted) {
+                    vertices.insert(vertices.end(), key.data, key.data + VERTEX_STRIDE);
                 }
 
                 // Add index
-                m_Indices.push_back(m_Indices.size());
+                indices.push_back(it->second);
+                faceCorners++;
             }
             index_offset += fv;
         }
     }
+
+    // Local-space bounds of the welded vertices
+    if (!vertices.empty()) {
+        meshData.boundsMin = glm::vec3(vertices[0], vertices[1], vertices[2]);
+        meshData.boundsMax = meshData.boundsMin;
+        for (size_t i = 0; i < vertices.size(); i += VERTEX_STRIDE) {
+            glm::vec3 position(vertices[i], vertices[i + 1], vertices[i + 2]);
+            meshData.boundsMin = glm::min(meshData.boundsMin, position);
+            meshData.boundsMax = glm::max(meshData.boundsMax, position);
+        }
+
+        // Sphere around the box center, usually much tighter than the box's half diagonal
+        glm::vec3 center = (meshData.boundsMin + meshData.boundsMax) * 0.5f;
+        float radiusSquared = 0.0f;
+        for (size_t i = 0; i < vertices.size(); i += VERTEX_STRIDE) {
+            glm::vec3 offset = glm::vec3(vertices[i], vertices[i + 1], vertices[i + 2]) - center;
+            radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+        }
+        meshData.boundsRadius = std::sqrt(radiusSquared);
+    }
+
+    return faceCorners;
 }
 
 void Model::setupMesh() {
@@ -119,15 +334,15 @@ void Model::setupMesh() {
     glGenBuffers(1, &m_VBO);
     glGenBuffers(1, &m_EBO);
 
-    glBindVertexArray(m_VAO);
+    GLState::bindVertexArray(m_VAO);
 
-    // Load vertex data
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-    glBufferData(GL_ARRAY_BUFFER, m_Vertices.size() * sizeof(float), m_Vertices.data(), GL_STATIC_DRAW);
+    // Straight from the mapping or the imported arrays; the index width was chosen when cooking
+    const MeshBufferView& buffers = m_PendingMesh->buffers;
+    GLState::bindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferData(GL_ARRAY_BUFFER, buffers.getVertexBytes(), buffers.vertices, GL_STATIC_DRAW);
 
-    // Load index data
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_Indices.size() * sizeof(unsigned int), m_Indices.data(), GL_STATIC_DRAW);
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, buffers.getIndexBytes(), buffers.indices, GL_STATIC_DRAW);
 
     // Set vertex attribute pointers
     // Position attribute
@@ -142,104 +357,144 @@ void Model::setupMesh() {
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
     glEnableVertexAttribArray(2);
 
-    // Unbind
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    // Unbind so later buffer binds cannot modify this vertex array
+    GLState::bindVertexArray(0);
 }
 
-void Model::render() {
-
-    if (!m_Materials.empty()) {
-        // Bind the first material's textures
-        // In a more advanced implementation, you might want to handle multiple materials
-        m_Materials[0]->bind();
-    }
-
-    glBindVertexArray(m_VAO);
-    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(m_Indices.size()), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
-
-    if (!m_Materials.empty()) {
-        m_Materials[0]->unbind();
+GLuint Model::getDiffuseTextureID() const {
+    if (m_Materials.empty() || !m_Materials[0]->getDiffuseTexture()) {
+        return 0;
     }
+    return m_Materials[0]->getDiffuseTexture()->getID();
 }
 
 void Model::cleanup() {
     if (m_VAO != 0) {
-        glDeleteVertexArrays(1, &m_VAO);
+        GLState::deleteVertexArray(m_VAO);
         m_VAO = 0;
     }
     if (m_VBO != 0) {
-        glDeleteBuffers(1, &m_VBO);
+        GLState::deleteBuffer(m_VBO);
         m_VBO = 0;
     }
     if (m_EBO != 0) {
-        glDeleteBuffers(1, &m_EBO);
+        GLState::deleteBuffer(m_EBO);
         m_EBO = 0;
     }
 }
 
-glm::mat4 Model::getModelMatrix() const {
+void Model::setPosition(const glm::vec3& position) {
+    if (position != m_Position) {
+        m_Position = position;
+        updateTransform();
+    }
+}
+
+void Model::setRotation(const glm::vec3& rotation) {
+    if (rotation != m_Rotation) {
+        m_Rotation = rotation;
+        updateTransform();
+    }
+}
+
+void Model::setScale(const glm::vec3& scale) {
+    if (scale != m_Scale) {
+        m_Scale = scale;
+        updateTransform();
+    }
+}
+
+void Model::updateTransform() {
     glm::mat4 model = glm::mat4(1.0f);
     model = glm::translate(model, m_Position);
     model = glm::rotate(model, m_Rotation.x, glm::vec3(1.0f, 0.0f, 0.0f));
     model = glm::rotate(model, m_Rotation.y, glm::vec3(0.0f, 1.0f, 0.0f));
     model = glm::rotate(model, m_Rotation.z, glm::vec3(0.0f, 0.0f, 1.0f));
     model = glm::scale(model, m_Scale);
-    return model;
+    m_ModelMatrix = model;
+
+    // Done once here instead of per vertex in the shader
+    m_NormalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+    updateWorldBounds();
+    m_TransformVersion++;
 }
 
-bool Model::loadMaterialTextures(const std::vector<tinyobj::material_t>& materials,
+void Model::updateWorldBounds() {
+    glm::vec3 localCenter = (m_BoundsMin + m_BoundsMax) * 0.5f;
+    glm::vec3 localHalfExtents = (m_BoundsMax - m_BoundsMin) * 0.5f;
+    m_WorldCenter = glm::vec3(m_ModelMatrix * glm::vec4(localCenter, 1.0f));
+
+    // Each world half extent is the absolute row of the 3x3 part dotted with the local ones
+    m_WorldHalfExtents = glm::vec3(0.0f);
+    float maxScale = 0.0f;
+    for (int column = 0; column < 3; column++) {
+        glm::vec3 axis(m_ModelMatrix[column]);
+        m_WorldHalfExtents += glm::abs(axis) * localHalfExtents[column];
+        maxScale = std::max(maxScale, glm::length(axis));
+    }
+    m_WorldRadius = m_BoundsRadius * maxScale;
+}
+
+bool Model::loadMaterialTextures(const std::vector<CookedMaterial>& materials,
     const std::string& baseDir) {
     bool allLoaded = true;
-    for (const auto& material : materials) {
+    size_t firstMaterial = m_Materials.size();
+
+    // Resolve every diffuse texture first so the whole model decodes as one parallel batch
+    std::vector<std::string> texturePaths;
+    std::vector<size_t> textureMaterials;
+    for (size_t i = 0; i < materials.size(); i++) {
+        const auto& material = materials[i];
         auto mat = std::make_shared<Material>(material.name);
 
-        // If there's a diffuse texture, load it
-        if (!material.diffuse_texname.empty()) {
+        // If there's a diffuse texture, find it
+        if (!material.diffuseTexname.empty()) {
             // Try different possible paths for the texture
             std::vector<std::string> possiblePaths = {
-                baseDir + material.diffuse_texname,                    
-                "gamedata/textures/" + material.diffuse_texname,       
-                baseDir + "../textures/" + material.diffuse_texname    
+                baseDir + material.diffuseTexname,                    
+                "gamedata/textures/" + material.diffuseTexname,       
+                baseDir + "../textures/" + material.diffuseTexname    
             };
 
-            bool textureLoaded = false;
+            bool textureFound = false;
             for (const auto& path : possiblePaths) {
                 if (std::filesystem::exists(path)) {
-                    if (mat->loadDiffuseTexture(path)) {
-                        textureLoaded = true;
-                        break;
-                    }
+                    texturePaths.push_back(path);
+                    textureMaterials.push_back(i);
+                    textureFound = true;
+                    break;
                 }
             }
 
-            if (!textureLoaded) {
-                std::cerr << "Failed to load texture: " << material.diffuse_texname << std::endl;
+            if (!textureFound) {
+                std::cerr << "Failed to load texture: " << material.diffuseTexname << std::endl;
                 allLoaded = false;
             }
         }
 
         // Store material properties (for future use with more complex materials)
-        mat->setAmbient(glm::vec3(
-            material.ambient[0],
-            material.ambient[1],
-            material.ambient[2]
-        ));
-        mat->setDiffuse(glm::vec3(
-            material.diffuse[0],
-            material.diffuse[1],
-            material.diffuse[2]
-        ));
+        mat->setAmbient(material.ambient);
+        mat->setDiffuse(material.diffuse);
         mat->setShininess(material.shininess);
 
         m_Materials.push_back(mat);
     }
 
+    // Decode (or share from the cache) all textures of this model at once
+    std::vector<std::shared_ptr<Texture>> textures = TextureCache::get().acquire(texturePaths);
+    for (size_t t = 0; t < textures.size(); t++) {
+        if (!textures[t]) {
+            std::cerr << "Failed to load texture: " << texturePaths[t] << std::endl;
+            allLoaded = false;
+            continue;
+        }
+        m_Materials[firstMaterial + textureMaterials[t]]->setDiffuseTexture(textures[t]);
+    }
+
     // If no materials were loaded, create a default material
     if (m_Materials.empty()) {
         m_Materials.push_back(std::make_shared<Material>("default"));
     }
 
     return allLoaded;
-}
\ No newline at end of file
+}
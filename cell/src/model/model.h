@@ -4,8 +4,11 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <cstdint>
 #include "tinyobj/tiny_obj_loader.h"
 #include "material.h"
+#include "mesh_cache.h"
+#include "collision_mesh.h"
 
 class Model {
 private:
@@ -13,24 +16,52 @@ private:
     GLuint m_VAO;
     GLuint m_VBO;
     GLuint m_EBO;
+    GLenum m_IndexType;  // GL_UNSIGNED_SHORT when the mesh fits, otherwise GL_UNSIGNED_INT
 
-    // Mesh data
-    std::vector<float> m_Vertices;  // Positions, normals, and texture coordinates interleaved
-    std::vector<unsigned int> m_Indices;
+    // Welded mesh waiting for uploadToGPU, mapped from the .cmesh or freshly imported;
+    // released once it is on the GPU
+    std::unique_ptr<CookedMeshData> m_PendingMesh;
+    GLsizei m_IndexCount;
 
     std::vector<std::shared_ptr<Material>> m_Materials;
 
+    // Local-space collision BVH, shared with other models of identical geometry
+    std::shared_ptr<const CollisionMesh> m_CollisionMesh;
+
     // Model properties 
     glm::vec3 m_Position;
     glm::vec3 m_Rotation;
     glm::vec3 m_Scale;
 
+    // Derived from position/rotation/scale, rebuilt only when one of them changes
+    glm::mat4 m_ModelMatrix;
+    glm::mat3 m_NormalMatrix;  // Inverse-transpose of the model matrix's upper 3x3
+
+    // Process-unique, never reused, so caches can key on it safely after the model is freed
+    uint64_t m_ID;
+    // Bumped whenever the model matrix changes
+    uint64_t m_TransformVersion;
+
+    // Local-space bounds of the mesh; the sphere is centered on the box
+    glm::vec3 m_BoundsMin;
+    glm::vec3 m_BoundsMax;
+    float m_BoundsRadius;
+
+    // The same bounds after the model matrix, for culling; rebuilt with the transform
+    glm::vec3 m_WorldCenter;
+    glm::vec3 m_WorldHalfExtents;
+    float m_WorldRadius;
+
     // Helper functions
     void setupMesh();
-    void processModelData(const tinyobj::attrib_t& attrib,
+    void updateTransform();
+    void updateWorldBounds();
+    bool importModel(const std::string& filepath, const std::string& baseDir, CookedMeshData& meshData);
+    // Returns the number of face corners before welding
+    size_t processModelData(const tinyobj::attrib_t& attrib,
         const std::vector<tinyobj::shape_t>& shapes,
-        const std::vector<tinyobj::material_t>& materials);
-    bool loadMaterialTextures(const std::vector<tinyobj::material_t>& materials,
+        CookedMeshData& meshData);
+    bool loadMaterialTextures(const std::vector<CookedMaterial>& materials,
         const std::string& modelPath);
 
 public:
@@ -43,18 +74,36 @@ public:
 
     // Core functionality
     bool loadModel(const std::string& filepath);
-    void render();
+
+    // Two-stage loading: loadModelData touches only disk and CPU memory and may run on a
+    // worker thread; uploadToGPU creates the GL objects and must run on the render thread
+    bool loadModelData(const std::string& filepath);
+    void uploadToGPU();
+    // What a render queue packet needs; the VAO is 0 until uploadToGPU
+    GLuint getVertexArray() const { return m_VAO; }
+    GLenum getIndexType() const { return m_IndexType; }
+    GLsizei getIndexCount() const { return m_IndexCount; }
+    // Texture of the first material, drawn on unit 0; 0 if it has none
+    GLuint getDiffuseTextureID() const;
     void cleanup();
 
     // Transformations
-    void setPosition(const glm::vec3& position) { m_Position = position; }
-    void setRotation(const glm::vec3& rotation) { m_Rotation = rotation; }
-    void setScale(const glm::vec3& scale) { m_Scale = scale; }
+    void setPosition(const glm::vec3& position);
+    void setRotation(const glm::vec3& rotation);
+    void setScale(const glm::vec3& scale);
 
-    glm::mat4 getModelMatrix() const;
+    const glm::mat4& getModelMatrix() const { return m_ModelMatrix; }
+    const glm::mat3& getNormalMatrix() const { return m_NormalMatrix; }
+    uint64_t getID() const { return m_ID; }
+    uint64_t getTransformVersion() const { return m_TransformVersion; }
 
     std::vector<int> m_MaterialIndices;
 
-    const std::vector<float>& getVertices() const { return m_Vertices; }
-    const std::vector<unsigned int>& getIndices() const { return m_Indices; }
+    const glm::vec3& getBoundsMin() const { return m_BoundsMin; }
+    const glm::vec3& getBoundsMax() const { return m_BoundsMax; }
+    float getBoundsRadius() const { return m_BoundsRadius; }
+    const glm::vec3& getWorldCenter() const { return m_WorldCenter; }
+    const glm::vec3& getWorldHalfExtents() const { return m_WorldHalfExtents; }
+    float getWorldRadius() const { return m_WorldRadius; }
+    const std::shared_ptr<const CollisionMesh>& getCollisionMesh() const { return m_CollisionMesh; }
 };
\ No newline at end of file
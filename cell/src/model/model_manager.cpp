@@ -1,74 +1,219 @@
 #include "model_manager.h"
 #include <algorithm>
+#include <chrono>
+#include <limits>
 #include <iostream>
 #include <filesystem>
 
+ModelManager::ModelManager(ThreadPool& jobPool)
+    : m_JobPool(jobPool)
+{
+}
+
+ModelManager::~ModelManager() {
+    // Loads that have not started skip their work; running ones push into m_CompletedLoads,
+    // so both must be done before it goes away
+    std::unique_lock<std::mutex> lock(m_CompletedMutex);
+    m_ShuttingDown = true;
+    m_LoadsFinished.wait(lock, [this]() { return m_InFlightLoads == 0; });
+}
+
+void ModelManager::syncSelection(const std::vector<std::string>& selectedModels, uint64_t generation) {
+    if (m_HasSelectionGeneration && generation == m_SelectionGeneration) {
+        return;
+    }
+
+    updateModelsFromSelection(selectedModels);
+    m_SelectionGeneration = generation;
+    m_HasSelectionGeneration = true;
+}
+
 void ModelManager::updateModelsFromSelection(const std::vector<std::string>& selectedModels) {
+    // Create the full paths once for the whole diff
+    std::unordered_set<std::string> selectedFullPaths;
+    selectedFullPaths.reserve(selectedModels.size());
+    for (const auto& modelPath : selectedModels) {
+        selectedFullPaths.insert("gamedata/models/" + modelPath);
+    }
+
     // First, remove any models that are no longer selected
-    removeUnselectedModels(selectedModels);
+    removeUnselectedModels(selectedFullPaths);
 
-    // Then, load any newly selected models
+    // Then, queue any newly selected models for background loading, in selection order
     for (const auto& modelPath : selectedModels) {
-        // Create the full path
         std::string fullPath = "gamedata/models/" + modelPath;
 
-        // Check if this model is already loaded
-        if (!isModelLoaded(fullPath)) {
-            // Create a new model
-            auto newModel = std::make_unique<Model>();
+        // Check if this model is already loaded or on its way
+        if (!isModelLoaded(fullPath) && !isModelPending(fullPath)) {
+            queueModelLoad(fullPath);
+        }
+    }
+}
+
+void ModelManager::queueModelLoad(const std::string& fullPath) {
+    m_PendingPaths.insert(fullPath);
+    {
+        std::lock_guard<std::mutex> lock(m_CompletedMutex);
+        m_InFlightLoads++;
+    }
 
-            // Try to load the model
-            if (newModel->loadModel(fullPath)) {
-                std::cout << "Successfully loaded model: " << modelPath << std::endl;
+    m_JobPool.submit([this, fullPath]() {
+        bool shuttingDown;
+        {
+            std::lock_guard<std::mutex> lock(m_CompletedMutex);
+            shuttingDown = m_ShuttingDown;
+        }
 
-            
-                // Store the model and its path
-                m_LoadedModels.push_back(std::move(newModel));
-                m_LoadedPaths.push_back(fullPath);
-            }
-            else {
-                std::cerr << "Failed to load model: " << modelPath << std::endl;
+        // Parse, process and decode textures off the render thread
+        std::unique_ptr<Model> newModel;
+        if (!shuttingDown) {
+            newModel = std::make_unique<Model>();
+            if (!newModel->loadModelData(fullPath)) {
+                newModel.reset();
             }
         }
+
+        std::lock_guard<std::mutex> lock(m_CompletedMutex);
+        m_CompletedLoads.push_back({ fullPath, std::move(newModel) });
+        m_HasCompletedLoads.store(true, std::memory_order_release);
+        // Notified under the lock: the destructor may return as soon as it sees zero
+        if (--m_InFlightLoads == 0) {
+            m_LoadsFinished.notify_all();
+        }
+    });
+}
+
+void ModelManager::processCompletedLoads() {
+    // Skip the lock entirely on the common frame where nothing finished
+    if (!m_HasCompletedLoads.exchange(false, std::memory_order_acquire)) {
+        return;
+    }
+
+    std::vector<CompletedLoad> completed;
+    {
+        std::lock_guard<std::mutex> lock(m_CompletedMutex);
+        completed.swap(m_CompletedLoads);
+    }
+
+    for (auto& load : completed) {
+        if (m_PendingPaths.erase(load.fullPath) == 0) {
+            // Deselected while it was loading
+            continue;
+        }
+
+        if (!load.model) {
+            std::cerr << "Failed to load model: " << load.fullPath << std::endl;
+            continue;
+        }
+
+        // GL objects can only be created on the render thread
+        load.model->uploadToGPU();
+        std::cout << "Successfully loaded model: " << load.fullPath << std::endl;
+
+        // Store the model and its path
+        m_LoadedModels.push_back(std::move(load.model));
+        m_LoadedPaths.push_back(load.fullPath);
+        m_LoadedPathSet.insert(load.fullPath);
+        m_CullBoundsDirty = true;
     }
 }
 
-void ModelManager::renderAll(const Shader& shader) {
-    // Render all loaded models
-    for (const auto& model : m_LoadedModels) {
-        // Update the model matrix uniform for this specific model
-        shader.setMat4("model", model->getModelMatrix());
-        model->render();
+void ModelManager::updateCullBounds() {
+    if (m_CullBoundsDirty) {
+        m_CullBounds.resize(m_LoadedModels.size());
+        // Never a real version, so every slot is rewritten below
+        m_CullTransformVersions.assign(m_LoadedModels.size(), std::numeric_limits<uint64_t>::max());
+        m_CullBoundsDirty = false;
+    }
+
+    for (size_t i = 0; i < m_LoadedModels.size(); i++) {
+        const Model& model = *m_LoadedModels[i];
+        if (m_CullTransformVersions[i] != model.getTransformVersion()) {
+            m_CullBounds.set(i, model.getWorldCenter(), model.getWorldRadius(), model.getWorldHalfExtents());
+            m_CullTransformVersions[i] = model.getTransformVersion();
+        }
+    }
+}
+
+void ModelManager::submitVisible(RenderQueue& queue, Shader& shader, const Frustum& frustum) {
+    auto cullStart = std::chrono::steady_clock::now();
+    updateCullBounds();
+
+    m_VisibleModels.clear();
+    if (m_FrustumCullingEnabled) {
+        frustum.cull(m_CullBounds, m_VisibleModels);
+    }
+    else {
+        for (size_t i = 0; i < m_LoadedModels.size(); i++) {
+            m_VisibleModels.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    m_CullStats.visible = m_VisibleModels.size();
+    m_CullStats.culled = m_LoadedModels.size() - m_VisibleModels.size();
+    m_CullStats.cullMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cullStart).count();
+
+    // Only the models that survived culling; the queue orders them
+    for (uint32_t index : m_VisibleModels) {
+        const Model& model = *m_LoadedModels[index];
+
+        DrawPacket packet;
+        packet.shader = &shader;
+        packet.vertexArray = model.getVertexArray();
+        packet.indexType = model.getIndexType();
+        packet.indexCount = model.getIndexCount();
+        packet.diffuseTexture = model.getDiffuseTextureID();
+        packet.modelMatrix = &model.getModelMatrix();
+        packet.normalMatrix = &model.getNormalMatrix();
+        queue.submit(packet, RenderPass::Opaque, model.getWorldCenter());
     }
 }
 
 void ModelManager::cleanup() {
     m_LoadedModels.clear();
     m_LoadedPaths.clear();
+    m_LoadedPathSet.clear();
+    m_CullBoundsDirty = true;
+    m_HasSelectionGeneration = false;
+    // Loads still in flight are discarded when they complete
+    m_PendingPaths.clear();
 }
 
 bool ModelManager::isModelLoaded(const std::string& modelPath) const {
-    return std::find(m_LoadedPaths.begin(), m_LoadedPaths.end(), modelPath) != m_LoadedPaths.end();
+    return m_LoadedPathSet.count(modelPath) != 0;
 }
 
-void ModelManager::removeUnselectedModels(const std::vector<std::string>& selectedModels) {
-    std::vector<std::string> selectedFullPaths;
-    // Create full paths for comparison
-    for (const auto& model : selectedModels) {
-        selectedFullPaths.push_back("gamedata/models/" + model);
-    }
+bool ModelManager::isModelPending(const std::string& modelPath) const {
+    return m_PendingPaths.count(modelPath) != 0;
+}
 
-    // Remove models that are no longer in the selection
-    for (size_t i = 0; i < m_LoadedPaths.size();) {
-        if (std::find(selectedFullPaths.begin(), selectedFullPaths.end(), m_LoadedPaths[i])
-            == selectedFullPaths.end()) {
+void ModelManager::removeUnselectedModels(const std::unordered_set<std::string>& selectedFullPaths) {
+    // Compact both parallel vectors in one pass, preserving load order
+    size_t kept = 0;
+    for (size_t i = 0; i < m_LoadedPaths.size(); i++) {
+        if (selectedFullPaths.count(m_LoadedPaths[i]) == 0) {
             // Model is no longer selected, remove it
-            m_LoadedModels.erase(m_LoadedModels.begin() + i);
-            m_LoadedPaths.erase(m_LoadedPaths.begin() + i);
+            m_LoadedPathSet.erase(m_LoadedPaths[i]);
+            m_LoadedModels[i].reset();
+            continue;
+        }
+        if (kept != i) {
+            m_LoadedModels[kept] = std::move(m_LoadedModels[i]);
+            m_LoadedPaths[kept] = std::move(m_LoadedPaths[i]);
+        }
+        kept++;
+    }
+    m_LoadedModels.resize(kept);
+    m_LoadedPaths.resize(kept);
+    m_CullBoundsDirty = true;
+
+    // Forget pending loads that were deselected; their results are dropped on arrival
+    for (auto it = m_PendingPaths.begin(); it != m_PendingPaths.end();) {
+        if (selectedFullPaths.count(*it) == 0) {
+            it = m_PendingPaths.erase(it);
         }
         else {
-            ++i;
+            ++it;
         }
     }
 }
-
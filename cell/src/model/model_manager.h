@@ -3,34 +3,97 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <unordered_set>
 #include "shader.h"
+#include "thread_pool.h"
+#include "frustum.h"
+#include "render_queue.h"
 
 class ModelManager {
+public:
+    struct CullStats {
+        size_t visible = 0;
+        size_t culled = 0;
+        double cullMs = 0.0;  // Bounds refresh and plane tests, last frame
+    };
+
 private:
+    // A model whose CPU-side loading finished on a worker thread
+    struct CompletedLoad {
+        std::string fullPath;
+        std::unique_ptr<Model> model;  // Null if loading failed
+    };
+
     // Store models using smart pointers for automatic memory management
     std::vector<std::unique_ptr<Model>> m_LoadedModels;
 
     // Keep track of loaded model paths to prevent duplicates
-    std::vector<std::string> m_LoadedPaths;
+    std::vector<std::string> m_LoadedPaths;          // Load order, parallel to m_LoadedModels
+    std::unordered_set<std::string> m_LoadedPathSet; // Same paths, for O(1) lookups
+
+    // Paths queued on the loader pool that have not been uploaded yet
+    std::unordered_set<std::string> m_PendingPaths;
+
+    // UI selection generation the loaded set was last diffed against
+    uint64_t m_SelectionGeneration = 0;
+    bool m_HasSelectionGeneration = false;
+
+    // Filled by loader threads, drained by processCompletedLoads on the render thread
+    std::mutex m_CompletedMutex;
+    std::vector<CompletedLoad> m_CompletedLoads;
+    // Loads submitted but not yet finished; the destructor waits for them since the pool outlives us
+    size_t m_InFlightLoads = 0;
+    bool m_ShuttingDown = false;
+    std::condition_variable m_LoadsFinished;
+    std::atomic<bool> m_HasCompletedLoads{ false };
+
+    // World bounds parallel to m_LoadedModels, refreshed only for models whose transform changed
+    CullBoundsSoA m_CullBounds;
+    std::vector<uint64_t> m_CullTransformVersions;
+    bool m_CullBoundsDirty = true;  // Set whenever models are added or removed
+    std::vector<uint32_t> m_VisibleModels;
+    bool m_FrustumCullingEnabled = true;
+    CullStats m_CullStats;
+
+    void updateCullBounds();
+
+    // Loads run as tasks on the shared job pool
+    ThreadPool& m_JobPool;
+
+    void queueModelLoad(const std::string& fullPath);
 
 public:
-    ModelManager() = default;
-    ~ModelManager() = default;
+    explicit ModelManager(ThreadPool& jobPool = ThreadPool::getShared());
+    ~ModelManager();
 
     // Prevent copying since we're managing unique resources
     ModelManager(const ModelManager&) = delete;
     ModelManager& operator=(const ModelManager&) = delete;
 
     // Core functionality
+    // Diffs against the selection only when its generation changed; cheap to call every frame
+    void syncSelection(const std::vector<std::string>& selectedModels, uint64_t generation);
     void updateModelsFromSelection(const std::vector<std::string>& selectedModels);
-    void renderAll(const Shader& shader);
+    // Uploads models whose background load finished; call once per frame on the render thread
+    void processCompletedLoads();
+    // Submits a draw for every model whose bounds intersect frustum; queue.execute() draws them
+    void submitVisible(RenderQueue& queue, Shader& shader, const Frustum& frustum);
     void cleanup();
 
     // Helper methods
     bool isModelLoaded(const std::string& modelPath) const;
-    void removeUnselectedModels(const std::vector<std::string>& selectedModels);
+    bool isModelPending(const std::string& modelPath) const;
+    void removeUnselectedModels(const std::unordered_set<std::string>& selectedFullPaths);
 
     const std::vector<std::string>& getLoadedPaths() const { return m_LoadedPaths; }
     const std::vector<std::unique_ptr<Model>>& getLoadedModels() const { return m_LoadedModels; }
 
-};
\ No newline at end of file
+    void setFrustumCullingEnabled(bool enabled) { m_FrustumCullingEnabled = enabled; }
+    bool isFrustumCullingEnabled() const { return m_FrustumCullingEnabled; }
+    const CullStats& getCullStats() const { return m_CullStats; }
+
+};
@@ -1,10 +1,13 @@
 #include "player.h"
 #include "ui.h"
+#include "gl_state.h"
 
 Player::Player(GLFWwindow* window)
     : m_Window(window)
     , m_Position(glm::vec3(0.0f, 5.0f, 0.0f))
     , m_Velocity(glm::vec3(0.0f))
+    , m_IsGrounded(false)
+    , m_PendingDisplacement(glm::vec3(0.0f))
     , m_Front(glm::vec3(0.0f, 0.0f, -1.0f))
     , m_WorldUp(glm::vec3(0.0f, 1.0f, 0.0f))
     , m_Yaw(-90.0f)
@@ -21,17 +24,17 @@ Player::Player(GLFWwindow* window)
 }
 
 Player::~Player() {
-    glDeleteBuffers(1, &m_AABBVertexBuffer);
-    glDeleteBuffers(1, &m_AABBIndexBuffer);
-    glDeleteVertexArrays(1, &m_AABBVertexArray);
+    GLState::deleteBuffer(m_AABBVertexBuffer);
+    GLState::deleteBuffer(m_AABBIndexBuffer);
+    GLState::deleteVertexArray(m_AABBVertexArray);
 }
 
 void Player::update(float deltaTime) {
     processKeyboard(deltaTime);
     applyGravity(deltaTime);
 
-    // Update position based on velocity
-    m_Position += m_Velocity * deltaTime;
+    // Applied by PlayerCollision, which sweeps the box so fast moves cannot pass through geometry
+    m_PendingDisplacement += m_Velocity * deltaTime;
 }
 
 void Player::applyGravity(float deltaTime) {
@@ -135,18 +138,18 @@ void Player::setupAABBMesh() {
     glGenBuffers(1, &m_AABBVertexBuffer);
     glGenBuffers(1, &m_AABBIndexBuffer);
 
-    glBindVertexArray(m_AABBVertexArray);
+    GLState::bindVertexArray(m_AABBVertexArray);
 
-    glBindBuffer(GL_ARRAY_BUFFER, m_AABBVertexBuffer);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, m_AABBVertexBuffer);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_AABBIndexBuffer);
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_AABBIndexBuffer);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
 
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
 
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 }
 
 void Player::renderAABB(const Shader& shader) const {
@@ -154,10 +157,9 @@ void Player::renderAABB(const Shader& shader) const {
     model = glm::translate(model, m_Position + glm::vec3(0.0f, m_AABBHalfExtents.y, 0.0f));
     model = glm::scale(model, m_AABBHalfExtents * 2.0f); // Double half-extents to get full size
 
-    shader.setMat4("model", model);
-    shader.setVec3("color", glm::vec3(0.0f, 1.0f, 0.0f)); // Green wireframe
+    shader.setMat4("model"_uniform, model);
+    shader.setVec3("color"_uniform, glm::vec3(0.0f, 1.0f, 0.0f)); // Green wireframe
 
-    glBindVertexArray(m_AABBVertexArray);
+    GLState::bindVertexArray(m_AABBVertexArray);
     glDrawElements(GL_LINES, 24, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
 }
\ No newline at end of file
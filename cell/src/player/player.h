@@ -12,6 +12,10 @@ private:
     // Position and movement
     glm::vec3 m_Position;
     glm::vec3 m_Velocity;
+    // Set by PlayerCollision from the contacts of the last step
+    bool m_IsGrounded;
+    // Movement integrated by update but not applied yet; PlayerCollision sweeps the box along it
+    glm::vec3 m_PendingDisplacement;
 
     // Rotation (in Euler angles)
     float m_Yaw;
@@ -67,4 +71,24 @@ public:
     void adjustPosition(const glm::vec3& adjustment) {
         m_Position += adjustment;
     }
+
+    void setAABBCenter(const glm::vec3& center) { m_Position = center; }
+
+    bool isGrounded() const { return m_IsGrounded; }
+    void setGrounded(bool grounded) { m_IsGrounded = grounded; }
+
+    // Returns the movement since the last call and clears it
+    glm::vec3 takePendingDisplacement() {
+        glm::vec3 displacement = m_PendingDisplacement;
+        m_PendingDisplacement = glm::vec3(0.0f);
+        return displacement;
+    }
+
+    // Removes the part of the velocity heading into a surface with this normal
+    void clipVelocity(const glm::vec3& normal) {
+        float into = glm::dot(m_Velocity, normal);
+        if (into < 0.0f) {
+            m_Velocity -= normal * into;
+        }
+    }
 };
\ No newline at end of file
@@ -1,28 +1,24 @@
 #pragma once
 #include "model_manager.h"
 #include "player.h"
-#include <vector>
+#include "collision_world.h"
+#include <cstdint>
+#include <unordered_map>
 #include <glm/glm.hpp>
 
-// Represents a triangle in world space for collision detection
-struct CollisionTriangle {
-    glm::vec3 v0, v1, v2;  // Vertices in world space
-    glm::vec3 normal;      // Triangle normal
-};
-
 class PlayerCollision {
 private:
     ModelManager& m_ModelManager;
     Player& m_Player;
-    std::vector<CollisionTriangle> m_WorldSpaceTriangles;
 
-    // Collision detection helpers
-    bool testAABBTriangleCollision(const CollisionTriangle& triangle, glm::vec3& penetrationVector) const;
-    void extractTrianglesFromModel(const Model& model, const glm::mat4& modelMatrix);
-    void updateWorldSpaceTriangles();
+    // Model instances over shared per-mesh BVHs, and the player's body among them
+    CollisionWorld m_World;
+    // Model::getTransformVersion last pushed into the scene, keyed by Model::getID
+    std::unordered_map<uint64_t, uint64_t> m_SyncedVersions;
+
+    static constexpr uint64_t PLAYER_BODY_ID = 0;
 
-    // Collision response
-    void resolveCollision(const glm::vec3& penetrationVector);
+    void syncScene();
 
 public:
     PlayerCollision(ModelManager& modelManager, Player& player);
@@ -32,9 +28,11 @@ public:
     PlayerCollision(const PlayerCollision&) = delete;
     PlayerCollision& operator=(const PlayerCollision&) = delete;
 
-    // Core functionality
+    // Core functionality: applies the player's pending movement, then pushes it out of any overlap
     void update();
 
+    CollisionWorld& getWorld() { return m_World; }
+
     // Debug rendering
     void renderCollisionGeometry(const Shader& shader) const;
 };
\ No newline at end of file
@@ -0,0 +1,264 @@
+#include "gl_state.h"
+
+namespace {
+    // No GL name or enum has this value, so a cached UNKNOWN never matches a request
+    constexpr GLuint UNKNOWN = 0xFFFFFFFFu;
+    constexpr int UNKNOWN_CAPABILITY = -1;
+
+    // Texture targets tracked per unit
+    constexpr int TEXTURE_TARGET_2D = 0;
+    constexpr int TEXTURE_TARGET_CUBE_MAP = 1;
+    constexpr int TEXTURE_TARGET_COUNT = 2;
+
+    struct CachedState {
+        GLuint program;
+        GLuint vertexArray;
+        GLuint arrayBuffer;
+        GLuint elementBuffer;
+        GLuint uniformBuffer;
+        GLuint uniformBindings[GLState::MAX_UNIFORM_BUFFER_BINDINGS];
+        GLuint activeUnit;
+        GLuint textures[GLState::MAX_TEXTURE_UNITS][TEXTURE_TARGET_COUNT];
+
+        int depthTest;
+        GLenum depthFunc;
+        int blend;
+        GLenum blendSource;
+        GLenum blendDestination;
+
+        GLState::Stats current;
+        GLState::Stats lastFrame;
+    };
+
+    void forgetAll(CachedState& state) {
+        state.program = UNKNOWN;
+        state.vertexArray = UNKNOWN;
+        state.arrayBuffer = UNKNOWN;
+        state.elementBuffer = UNKNOWN;
+        state.uniformBuffer = UNKNOWN;
+        for (GLuint& binding : state.uniformBindings) {
+            binding = UNKNOWN;
+        }
+        state.activeUnit = UNKNOWN;
+        for (auto& unit : state.textures) {
+            for (GLuint& texture : unit) {
+                texture = UNKNOWN;
+            }
+        }
+
+        state.depthTest = UNKNOWN_CAPABILITY;
+        state.depthFunc = UNKNOWN;
+        state.blend = UNKNOWN_CAPABILITY;
+        state.blendSource = UNKNOWN;
+        state.blendDestination = UNKNOWN;
+    }
+
+    CachedState& cached() {
+        static CachedState state = [] {
+            CachedState initial = {};
+            forgetAll(initial);
+            return initial;
+        }();
+        return state;
+    }
+
+    // Records value and returns true when the call has to reach the driver
+    bool changes(GLuint& current, GLuint value) {
+        GLState::Stats& stats = cached().current;
+        if (current == value) {
+            stats.filtered++;
+            return false;
+        }
+        current = value;
+        stats.issued++;
+        return true;
+    }
+
+    void setCapability(int& current, GLenum capability, bool enabled) {
+        GLState::Stats& stats = cached().current;
+        int value = enabled ? 1 : 0;
+        if (current == value) {
+            stats.filtered++;
+            return;
+        }
+        current = value;
+        stats.issued++;
+        if (enabled) {
+            glEnable(capability);
+        }
+        else {
+            glDisable(capability);
+        }
+    }
+
+    GLuint* getBufferSlot(GLenum target) {
+        switch (target) {
+        case GL_ARRAY_BUFFER: return &cached().arrayBuffer;
+        case GL_ELEMENT_ARRAY_BUFFER: return &cached().elementBuffer;
+        case GL_UNIFORM_BUFFER: return &cached().uniformBuffer;
+        default: return nullptr;
+        }
+    }
+
+    int getTextureTargetIndex(GLenum target) {
+        switch (target) {
+        case GL_TEXTURE_2D: return TEXTURE_TARGET_2D;
+        case GL_TEXTURE_CUBE_MAP: return TEXTURE_TARGET_CUBE_MAP;
+        default: return -1;
+        }
+    }
+
+    void forgetName(GLuint& binding, GLuint name) {
+        if (binding == name) {
+            binding = UNKNOWN;
+        }
+    }
+}
+
+void GLState::useProgram(GLuint program) {
+    if (changes(cached().program, program)) {
+        glUseProgram(program);
+    }
+}
+
+void GLState::bindVertexArray(GLuint vertexArray) {
+    CachedState& state = cached();
+    if (changes(state.vertexArray, vertexArray)) {
+        glBindVertexArray(vertexArray);
+        // The element buffer binding is whatever the new vertex array holds
+        state.elementBuffer = UNKNOWN;
+    }
+}
+
+void GLState::bindBuffer(GLenum target, GLuint buffer) {
+    GLuint* slot = getBufferSlot(target);
+    if (!slot) {
+        // Untracked target: always issued
+        cached().current.issued++;
+        glBindBuffer(target, buffer);
+        return;
+    }
+    if (changes(*slot, buffer)) {
+        glBindBuffer(target, buffer);
+    }
+}
+
+void GLState::bindUniformBuffer(GLuint index, GLuint buffer) {
+    CachedState& state = cached();
+    if (index >= MAX_UNIFORM_BUFFER_BINDINGS) {
+        state.current.issued++;
+        glBindBufferBase(GL_UNIFORM_BUFFER, index, buffer);
+        state.uniformBuffer = buffer;
+        return;
+    }
+    if (changes(state.uniformBindings[index], buffer)) {
+        glBindBufferBase(GL_UNIFORM_BUFFER, index, buffer);
+        state.uniformBuffer = buffer;
+    }
+}
+
+void GLState::bindTexture(GLuint unit, GLenum target, GLuint texture) {
+    CachedState& state = cached();
+    int targetIndex = getTextureTargetIndex(target);
+
+    // Checked before selecting the unit so a filtered bind costs nothing at all
+    if (unit < MAX_TEXTURE_UNITS && targetIndex >= 0 && state.textures[unit][targetIndex] == texture) {
+        state.current.filtered++;
+        return;
+    }
+
+    if (changes(state.activeUnit, unit)) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+    state.current.issued++;
+    glBindTexture(target, texture);
+    if (unit < MAX_TEXTURE_UNITS && targetIndex >= 0) {
+        state.textures[unit][targetIndex] = texture;
+    }
+}
+
+void GLState::setDepthTest(bool enabled) {
+    setCapability(cached().depthTest, GL_DEPTH_TEST, enabled);
+}
+
+void GLState::setDepthFunc(GLenum func) {
+    if (changes(cached().depthFunc, func)) {
+        glDepthFunc(func);
+    }
+}
+
+void GLState::setBlend(bool enabled) {
+    setCapability(cached().blend, GL_BLEND, enabled);
+}
+
+void GLState::setBlendFunc(GLenum source, GLenum destination) {
+    CachedState& state = cached();
+    if (state.blendSource == source && state.blendDestination == destination) {
+        state.current.filtered++;
+        return;
+    }
+    state.blendSource = source;
+    state.blendDestination = destination;
+    state.current.issued++;
+    glBlendFunc(source, destination);
+}
+
+void GLState::deleteProgram(GLuint program) {
+    if (program == 0) {
+        return;
+    }
+    forgetName(cached().program, program);
+    glDeleteProgram(program);
+}
+
+void GLState::deleteVertexArray(GLuint vertexArray) {
+    if (vertexArray == 0) {
+        return;
+    }
+    CachedState& state = cached();
+    if (state.vertexArray == vertexArray) {
+        state.vertexArray = UNKNOWN;
+        state.elementBuffer = UNKNOWN;
+    }
+    glDeleteVertexArrays(1, &vertexArray);
+}
+
+void GLState::deleteBuffer(GLuint buffer) {
+    if (buffer == 0) {
+        return;
+    }
+    CachedState& state = cached();
+    forgetName(state.arrayBuffer, buffer);
+    forgetName(state.elementBuffer, buffer);
+    forgetName(state.uniformBuffer, buffer);
+    for (GLuint& binding : state.uniformBindings) {
+        forgetName(binding, buffer);
+    }
+    glDeleteBuffers(1, &buffer);
+}
+
+void GLState::deleteTexture(GLuint texture) {
+    if (texture == 0) {
+        return;
+    }
+    for (auto& unit : cached().textures) {
+        for (GLuint& binding : unit) {
+            forgetName(binding, texture);
+        }
+    }
+    glDeleteTextures(1, &texture);
+}
+
+void GLState::invalidate() {
+    forgetAll(cached());
+}
+
+void GLState::beginFrame() {
+    CachedState& state = cached();
+    state.lastFrame = state.current;
+    state.current = Stats();
+}
+
+const GLState::Stats& GLState::getFrameStats() {
+    return cached().lastFrame;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstddef>
+
+// Shadow copy of the GL bindings and fixed-function state the engine touches. Every call
+// compares against the last value set through here and only reaches the driver on a change;
+// both outcomes are counted. Only valid while all engine code changes this state through
+// GLState. Code that changes it behind our back and restores it (the ImGui backend does)
+// is fine; code that does not must call invalidate() afterwards.
+//
+// One context, main thread only.
+class GLState {
+public:
+    struct Stats {
+        size_t issued = 0;    // Calls that reached the driver
+        size_t filtered = 0;  // Calls dropped because the state already matched
+    };
+
+    static constexpr GLuint MAX_TEXTURE_UNITS = 16;
+    static constexpr GLuint MAX_UNIFORM_BUFFER_BINDINGS = 16;
+
+    static void useProgram(GLuint program);
+    static void bindVertexArray(GLuint vertexArray);
+    // GL_ELEMENT_ARRAY_BUFFER is part of the bound vertex array, so it is forgotten whenever
+    // the vertex array changes
+    static void bindBuffer(GLenum target, GLuint buffer);
+    // Also sets the generic GL_UNIFORM_BUFFER binding, as glBindBufferBase does
+    static void bindUniformBuffer(GLuint index, GLuint buffer);
+    // Selects unit first if needed; 2D and cube map bindings are tracked per unit
+    static void bindTexture(GLuint unit, GLenum target, GLuint texture);
+
+    static void setDepthTest(bool enabled);
+    static void setDepthFunc(GLenum func);
+    static void setBlend(bool enabled);
+    static void setBlendFunc(GLenum source, GLenum destination);
+
+    // Delete the object and forget any binding of it, since GL may hand the name out again
+    static void deleteProgram(GLuint program);
+    static void deleteVertexArray(GLuint vertexArray);
+    static void deleteBuffer(GLuint buffer);
+    static void deleteTexture(GLuint texture);
+
+    // Marks everything unknown; the next call of each kind always reaches the driver
+    static void invalidate();
+
+    // Closes the current frame's counters; getFrameStats returns the last closed frame
+    static void beginFrame();
+    static const Stats& getFrameStats();
+};
@@ -0,0 +1,157 @@
+#include "render_queue.h"
+#include "gl_state.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+    constexpr uint64_t DEPTH_MASK = (1ull << RenderQueue::DEPTH_BITS) - 1;
+    constexpr uint64_t PROGRAM_MASK = 0xFF;
+    constexpr uint64_t TEXTURE_MASK = 0xFFFF;
+    constexpr uint64_t VERTEX_ARRAY_MASK = 0x3FFF;
+
+    // 8 passes of one byte each
+    constexpr int RADIX_BITS = 8;
+    constexpr int RADIX_BUCKETS = 1 << RADIX_BITS;
+    constexpr int RADIX_PASSES = 64 / RADIX_BITS;
+}
+
+uint64_t RenderQueue::getProgramSlot(Shader* shader) {
+    // Programs are few; the slot of a program stays the same for the life of the queue
+    auto it = std::find(m_Programs.begin(), m_Programs.end(), shader);
+    if (it == m_Programs.end()) {
+        m_Programs.push_back(shader);
+        it = m_Programs.end() - 1;
+    }
+    return std::min<uint64_t>(static_cast<uint64_t>(it - m_Programs.begin()), PROGRAM_MASK);
+}
+
+void RenderQueue::begin(const glm::mat4& view, float maxDepth) {
+    m_View = view;
+    m_MaxDepth = maxDepth;
+    m_Packets.clear();
+    m_Entries.clear();
+}
+
+void RenderQueue::submit(const DrawPacket& packet, RenderPass pass, const glm::vec3& worldCenter) {
+    // Distance in front of the camera, quantized over [0, maxDepth]
+    float viewDepth = -(m_View * glm::vec4(worldCenter, 1.0f)).z;
+    float normalizedDepth = std::clamp(viewDepth / m_MaxDepth, 0.0f, 1.0f);
+    uint64_t depth = static_cast<uint64_t>(normalizedDepth * DEPTH_MASK);
+
+    uint64_t program = getProgramSlot(packet.shader);
+    uint64_t texture = packet.diffuseTexture & TEXTURE_MASK;
+    uint64_t vertexArray = packet.vertexArray & VERTEX_ARRAY_MASK;
+
+    uint64_t key = static_cast<uint64_t>(pass) << 62;
+    if (pass == RenderPass::Transparent) {
+        key |= (DEPTH_MASK - depth) << 38 | program << 30 | texture << 14 | vertexArray;
+    }
+    else {
+        key |= program << 54 | texture << 38 | depth << 14 | vertexArray;
+    }
+
+    m_Entries.push_back({ key, static_cast<uint32_t>(m_Packets.size()) });
+    m_Packets.push_back(packet);
+}
+
+void RenderQueue::sort() {
+    size_t count = m_Entries.size();
+    if (count < 2) {
+        return;
+    }
+
+    // One read of the keys builds the histogram of every byte
+    uint32_t histograms[RADIX_PASSES][RADIX_BUCKETS] = {};
+    for (const SortEntry& entry : m_Entries) {
+        for (int pass = 0; pass < RADIX_PASSES; pass++) {
+            histograms[pass][(entry.key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+        }
+    }
+
+    // Stable least-significant-byte first passes
+    m_SortScratch.resize(count);
+    for (int pass = 0; pass < RADIX_PASSES; pass++) {
+        uint32_t* histogram = histograms[pass];
+        int shift = pass * RADIX_BITS;
+
+        // Every key has the same byte here, so this pass would not move anything
+        if (histogram[(m_Entries[0].key >> shift) & (RADIX_BUCKETS - 1)] == count) {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for (int bucket = 0; bucket < RADIX_BUCKETS; bucket++) {
+            uint32_t bucketCount = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucketCount;
+        }
+        for (const SortEntry& entry : m_Entries) {
+            m_SortScratch[histogram[(entry.key >> shift) & (RADIX_BUCKETS - 1)]++] = entry;
+        }
+        m_Entries.swap(m_SortScratch);
+    }
+}
+
+void RenderQueue::execute() {
+    m_Stats = Stats();
+
+    auto sortStart = std::chrono::steady_clock::now();
+    sort();
+    m_Stats.sortMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sortStart).count();
+
+    // Changes are counted here from the sort order; GLState still filters the first draw's
+    // binds against whatever the previous frame left bound
+    Shader* currentShader = nullptr;
+    GLuint currentTexture = 0;
+    GLuint currentVertexArray = 0;
+    bool hasTexture = false;
+    bool hasVertexArray = false;
+    bool blending = false;
+    UniformHandle modelUniform;
+    UniformHandle normalUniform;
+
+    for (const SortEntry& entry : m_Entries) {
+        const DrawPacket& packet = m_Packets[entry.packet];
+
+        // Transparent keys sort after every opaque one, so blending is switched on once
+        if (!blending && (entry.key >> 62) == static_cast<uint64_t>(RenderPass::Transparent)) {
+            GLState::setBlend(true);
+            GLState::setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            blending = true;
+        }
+
+        if (packet.shader != currentShader) {
+            currentShader = packet.shader;
+            currentShader->use();
+            // Resolved once per program change instead of per draw
+            modelUniform = currentShader->getUniform("model"_uniform);
+            normalUniform = currentShader->getUniform("normalMatrix"_uniform);
+            m_Stats.programBinds++;
+        }
+        if (!hasTexture || packet.diffuseTexture != currentTexture) {
+            GLState::bindTexture(0, GL_TEXTURE_2D, packet.diffuseTexture);
+            currentTexture = packet.diffuseTexture;
+            hasTexture = true;
+            m_Stats.textureBinds++;
+        }
+        if (!hasVertexArray || packet.vertexArray != currentVertexArray) {
+            GLState::bindVertexArray(packet.vertexArray);
+            currentVertexArray = packet.vertexArray;
+            hasVertexArray = true;
+            m_Stats.vertexArrayBinds++;
+        }
+
+        currentShader->setMat4(modelUniform, *packet.modelMatrix);
+        currentShader->setMat3(normalUniform, *packet.normalMatrix);
+        glDrawElements(GL_TRIANGLES, packet.indexCount, packet.indexType, nullptr);
+        m_Stats.draws++;
+    }
+
+    // Bindings stay as the last draw left them; only blending is undone for later passes
+    if (blending) {
+        GLState::setBlend(false);
+    }
+
+    m_Packets.clear();
+    m_Entries.clear();
+}
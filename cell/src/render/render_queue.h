@@ -0,0 +1,73 @@
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "shader.h"
+
+enum class RenderPass : uint8_t {
+    Opaque = 0,       // Front to back, grouped by state
+    Transparent = 1,  // Back to front, after every opaque draw
+};
+
+// Everything one indexed draw needs. The matrices are owned by the submitter and must stay
+// valid until execute() returns.
+struct DrawPacket {
+    Shader* shader = nullptr;
+    GLuint vertexArray = 0;
+    GLenum indexType = GL_UNSIGNED_INT;
+    GLsizei indexCount = 0;
+    GLuint diffuseTexture = 0;  // Bound to unit 0; 0 for none
+    const glm::mat4* modelMatrix = nullptr;
+    const glm::mat3* normalMatrix = nullptr;
+};
+
+// Per-frame list of draws. Each submitted packet gets a 64-bit sort key; execute() radix
+// sorts the keys and issues the draws in key order, binding a program, texture or vertex
+// array only when it differs from the previous draw's.
+//
+// Opaque key, high to low bits: pass (2) | program (8) | texture (16) | depth (24) | vertex array (14).
+// Transparent key: pass (2) | inverted depth (24) | program (8) | texture (16) | vertex array (14).
+// Texture and vertex array fields hold the low bits of the GL names; they only group draws,
+// the actual names are compared when executing.
+class RenderQueue {
+public:
+    struct Stats {
+        size_t draws = 0;
+        size_t programBinds = 0;
+        size_t textureBinds = 0;
+        size_t vertexArrayBinds = 0;
+        double sortMs = 0.0;
+    };
+
+private:
+    struct SortEntry {
+        uint64_t key;
+        uint32_t packet;
+    };
+
+    std::vector<DrawPacket> m_Packets;
+    std::vector<SortEntry> m_Entries;
+    std::vector<SortEntry> m_SortScratch;
+    std::vector<Shader*> m_Programs;  // Index in here is the program field of the key
+
+    glm::mat4 m_View = glm::mat4(1.0f);
+    float m_MaxDepth = 1.0f;
+    Stats m_Stats;
+
+    uint64_t getProgramSlot(Shader* shader);
+    void sort();
+
+public:
+    static constexpr int DEPTH_BITS = 24;
+
+    // Starts a frame; depths are view-space distances, clamped to maxDepth (the far plane)
+    void begin(const glm::mat4& view, float maxDepth);
+    // worldCenter is the point the draw is depth sorted by
+    void submit(const DrawPacket& packet, RenderPass pass, const glm::vec3& worldCenter);
+    // Sorts, draws and clears the queue
+    void execute();
+
+    size_t getPacketCount() const { return m_Packets.size(); }
+    const Stats& getStats() const { return m_Stats; }
+};
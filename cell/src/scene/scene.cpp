@@ -36,8 +36,9 @@ json Scene::createSceneStateJson() const {
 
     scene["version"] = SCENE_VERSION;
 
+    // The selection, not what has finished loading, so a save during a load keeps every model
     json loadedModels = json::array();
-    const auto& modelPaths = m_ModelManager->getLoadedPaths();
+    const auto& modelPaths = m_UI->getSelectedModels();
 
     for (const auto& path : modelPaths) {
         json modelInfo;
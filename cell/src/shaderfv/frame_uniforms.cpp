@@ -0,0 +1,39 @@
+#include "frame_uniforms.h"
+#include "gl_state.h"
+
+FrameUniforms::FrameUniforms() : m_Buffer(0) {}
+
+FrameUniforms::~FrameUniforms() {
+    cleanup();
+}
+
+bool FrameUniforms::init() {
+    glGenBuffers(1, &m_Buffer);
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, m_Buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(Data), nullptr, GL_DYNAMIC_DRAW);
+
+    GLState::bindUniformBuffer(BINDING, m_Buffer);
+
+    return m_Buffer != 0;
+}
+
+void FrameUniforms::update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPosition, float time) {
+    Data data;
+    data.view = view;
+    data.projection = projection;
+    data.viewProjection = projection * view;
+    data.cameraPosition = cameraPosition;
+    data.time = time;
+
+    // Filtered unless something else took the slot; glBufferSubData needs the generic binding too
+    GLState::bindUniformBuffer(BINDING, m_Buffer);
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, m_Buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Data), &data);
+}
+
+void FrameUniforms::cleanup() {
+    if (m_Buffer != 0) {
+        GLState::deleteBuffer(m_Buffer);
+        m_Buffer = 0;
+    }
+}
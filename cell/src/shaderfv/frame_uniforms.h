@@ -0,0 +1,46 @@
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+// Frame-constant data shared by every program through one std140 uniform block.
+// Shaders declare it as:
+//
+//   layout (std140) uniform FrameData {
+//       mat4 view;
+//       mat4 projection;
+//       mat4 viewProjection;
+//       vec3 cameraPosition;
+//       float time;
+//   };
+//
+// Shader::init binds any block with that name to BINDING, so the buffer is
+// uploaded once per frame no matter how many programs read it.
+class FrameUniforms {
+private:
+    // Mirrors the std140 layout above: the vec3 and float share one 16-byte slot
+    struct Data {
+        glm::mat4 view;
+        glm::mat4 projection;
+        glm::mat4 viewProjection;
+        glm::vec3 cameraPosition;
+        float time;
+    };
+    static_assert(sizeof(Data) == 208, "FrameUniforms::Data must match the std140 FrameData block");
+
+    GLuint m_Buffer;
+
+public:
+    static constexpr GLuint BINDING = 0;
+    static constexpr const char* BLOCK_NAME = "FrameData";
+
+    FrameUniforms();
+    ~FrameUniforms();
+
+    // Prevent copying since we're managing OpenGL resources
+    FrameUniforms(const FrameUniforms&) = delete;
+    FrameUniforms& operator=(const FrameUniforms&) = delete;
+
+    bool init();
+    void update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPosition, float time);
+    void cleanup();
+};
@@ -1,4 +1,6 @@
 #include "shader.h"
+#include "frame_uniforms.h"
+#include "gl_state.h"
 
 Shader::Shader() : m_ProgramID(0) {}
 
@@ -25,39 +27,107 @@ bool Shader::init(const std::string& vertexPath, const std::string& fragmentPath
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
 
+    reflectUniforms();
+    bindUniformBlock(FrameUniforms::BLOCK_NAME, FrameUniforms::BINDING);
+
     return true;
 }
 
 void Shader::use() {
-    glUseProgram(m_ProgramID);
+    GLState::useProgram(m_ProgramID);
 }
 
 void Shader::cleanup() {
     if (m_ProgramID != 0) {
-        glDeleteProgram(m_ProgramID);
+        GLState::deleteProgram(m_ProgramID);
         m_ProgramID = 0;
     }
+    m_Uniforms.clear();
+}
+
+void Shader::reflectUniforms() {
+    m_Uniforms.clear();
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(m_ProgramID, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        return;
+    }
+
+    GLint uniformCount = 0;
+    GLint maxNameLength = 0;
+    glGetProgramiv(m_ProgramID, GL_ACTIVE_UNIFORMS, &uniformCount);
+    glGetProgramiv(m_ProgramID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::string name(static_cast<size_t>(maxNameLength), '\0');
+    for (GLint i = 0; i < uniformCount; i++) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = GL_NONE;
+        glGetActiveUniform(m_ProgramID, static_cast<GLuint>(i), maxNameLength, &length, &size, &type, name.data());
+
+        std::string_view uniformName(name.data(), static_cast<size_t>(length));
+        GLint location = glGetUniformLocation(m_ProgramID, name.c_str());
+
+        // Members of uniform blocks have no location
+        if (location < 0) {
+            continue;
+        }
+
+        // Arrays are reported as "name[0]"; register the bare name too
+        std::string_view suffix = "[0]";
+        std::string_view names[2] = { uniformName, uniformName };
+        size_t nameCount = 1;
+        if (uniformName.size() > suffix.size() && uniformName.substr(uniformName.size() - suffix.size()) == suffix) {
+            names[1] = uniformName.substr(0, uniformName.size() - suffix.size());
+            nameCount = 2;
+        }
+
+        for (size_t n = 0; n < nameCount; n++) {
+            auto [it, inserted] = m_Uniforms.try_emplace(hashUniformName(names[n]), location, type);
+            if (!inserted && it->second.getLocation() != location) {
+                std::cerr << "Uniform name hash collision on: " << names[n] << std::endl;
+            }
+        }
+    }
+}
+
+void Shader::bindUniformBlock(const char* blockName, GLuint binding) {
+    // Programs that don't declare the block are left alone
+    GLuint blockIndex = glGetUniformBlockIndex(m_ProgramID, blockName);
+    if (blockIndex != GL_INVALID_INDEX) {
+        glUniformBlockBinding(m_ProgramID, blockIndex, binding);
+    }
+}
+
+UniformHandle Shader::findUniform(uint64_t hash) const {
+    auto it = m_Uniforms.find(hash);
+    return it != m_Uniforms.end() ? it->second : UniformHandle();
 }
 
 // Uniform setters
-void Shader::setBool(const std::string& name, bool value) const {
-    glUniform1i(glGetUniformLocation(m_ProgramID, name.c_str()), (int)value);
+void Shader::setBool(UniformHandle handle, bool value) const {
+    glUniform1i(handle.getLocation(), (int)value);
+}
+
+void Shader::setInt(UniformHandle handle, int value) const {
+    glUniform1i(handle.getLocation(), value);
 }
 
-void Shader::setInt(const std::string& name, int value) const {
-    glUniform1i(glGetUniformLocation(m_ProgramID, name.c_str()), value);
+void Shader::setFloat(UniformHandle handle, float value) const {
+    glUniform1f(handle.getLocation(), value);
 }
 
-void Shader::setFloat(const std::string& name, float value) const {
-    glUniform1f(glGetUniformLocation(m_ProgramID, name.c_str()), value);
+void Shader::setVec3(UniformHandle handle, const glm::vec3& value) const {
+    glUniform3fv(handle.getLocation(), 1, &value[0]);
 }
 
-void Shader::setVec3(const std::string& name, const glm::vec3& value) const {
-    glUniform3fv(glGetUniformLocation(m_ProgramID, name.c_str()), 1, &value[0]);
+void Shader::setMat3(UniformHandle handle, const glm::mat3& mat) const {
+    glUniformMatrix3fv(handle.getLocation(), 1, GL_FALSE, &mat[0][0]);
 }
 
-void Shader::setMat4(const std::string& name, const glm::mat4& mat) const {
-    glUniformMatrix4fv(glGetUniformLocation(m_ProgramID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+void Shader::setMat4(UniformHandle handle, const glm::mat4& mat) const {
+    glUniformMatrix4fv(handle.getLocation(), 1, GL_FALSE, &mat[0][0]);
 }
 
 // Helper functions
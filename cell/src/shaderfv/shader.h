@@ -1,19 +1,64 @@
 #pragma once
 #include <GL/glew.h>
 #include <glm/glm.hpp>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 
+// FNV-1a over a uniform name. constexpr so literal names can be hashed at compile time.
+constexpr uint64_t hashUniformName(std::string_view name) {
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// A uniform name whose hash is computed at compile time: shader.setMat4("model"_uniform, m)
+struct UniformName {
+    uint64_t hash;
+    const char* name;
+};
+
+consteval UniformName operator""_uniform(const char* name, size_t length) {
+    return UniformName{ hashUniformName(std::string_view(name, length)), name };
+}
+
+// Location of an active uniform in one program, resolved once and reused every frame.
+// Default-constructed handles are invalid and ignored by the setters, like location -1.
+class UniformHandle {
+private:
+    GLint m_Location;
+    GLenum m_Type;
+
+public:
+    UniformHandle() : m_Location(-1), m_Type(GL_NONE) {}
+    UniformHandle(GLint location, GLenum type) : m_Location(location), m_Type(type) {}
+
+    bool isValid() const { return m_Location >= 0; }
+    GLint getLocation() const { return m_Location; }
+    GLenum getType() const { return m_Type; }
+};
+
 class Shader {
 private:
     GLuint m_ProgramID;
 
+    // Every active uniform of the linked program, keyed by hashUniformName
+    std::unordered_map<uint64_t, UniformHandle> m_Uniforms;
+
     // Helper functions for shader compilation and error checking
     std::string readShaderFile(const std::string& filePath);
     GLuint compileShader(const std::string& source, GLenum shaderType);
     void checkCompileErrors(GLuint shader, const std::string& type);
+    void reflectUniforms();
+    UniformHandle findUniform(uint64_t hash) const;
+    void bindUniformBlock(const char* blockName, GLuint binding);
 
 public:
     Shader();
@@ -27,10 +72,29 @@ public:
     void use();
     void cleanup();
 
-    // Uniform setters
-    void setBool(const std::string& name, bool value) const;
-    void setInt(const std::string& name, int value) const;
-    void setFloat(const std::string& name, float value) const;
-    void setVec3(const std::string& name, const glm::vec3& value) const;
-    void setMat4(const std::string& name, const glm::mat4& mat) const;
+    // Uniform lookup. Unknown or inactive names return an invalid handle.
+    UniformHandle getUniform(UniformName name) const { return findUniform(name.hash); }
+    UniformHandle getUniform(std::string_view name) const { return findUniform(hashUniformName(name)); }
+
+    // Uniform setters, by resolved handle (fastest), compile-time hashed name, or string
+    void setBool(UniformHandle handle, bool value) const;
+    void setInt(UniformHandle handle, int value) const;
+    void setFloat(UniformHandle handle, float value) const;
+    void setVec3(UniformHandle handle, const glm::vec3& value) const;
+    void setMat3(UniformHandle handle, const glm::mat3& mat) const;
+    void setMat4(UniformHandle handle, const glm::mat4& mat) const;
+
+    void setBool(UniformName name, bool value) const { setBool(getUniform(name), value); }
+    void setInt(UniformName name, int value) const { setInt(getUniform(name), value); }
+    void setFloat(UniformName name, float value) const { setFloat(getUniform(name), value); }
+    void setVec3(UniformName name, const glm::vec3& value) const { setVec3(getUniform(name), value); }
+    void setMat3(UniformName name, const glm::mat3& mat) const { setMat3(getUniform(name), mat); }
+    void setMat4(UniformName name, const glm::mat4& mat) const { setMat4(getUniform(name), mat); }
+
+    void setBool(const std::string& name, bool value) const { setBool(getUniform(name), value); }
+    void setInt(const std::string& name, int value) const { setInt(getUniform(name), value); }
+    void setFloat(const std::string& name, float value) const { setFloat(getUniform(name), value); }
+    void setVec3(const std::string& name, const glm::vec3& value) const { setVec3(getUniform(name), value); }
+    void setMat3(const std::string& name, const glm::mat3& mat) const { setMat3(getUniform(name), mat); }
+    void setMat4(const std::string& name, const glm::mat4& mat) const { setMat4(getUniform(name), mat); }
 };
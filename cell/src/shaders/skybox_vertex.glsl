@@ -3,11 +3,17 @@ layout (location = 0) in vec3 aPos;
 
 out vec3 TexCoords;
 
-uniform mat4 view;
-uniform mat4 projection;
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec3 cameraPosition;
+    float time;
+};
 
 void main() {
     TexCoords = aPos;
-    vec4 pos = projection * view * vec4(aPos, 1.0);
+    // Drop the translation so the skybox stays centered on the camera
+    vec4 pos = projection * mat4(mat3(view)) * vec4(aPos, 1.0);
     gl_Position = pos.xyww; // This ensures the skybox is always rendered at maximum depth
 }
\ No newline at end of file
@@ -4,8 +4,15 @@ layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+uniform mat3 normalMatrix;  // Inverse-transpose of model, computed on the CPU
+
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec3 cameraPosition;
+    float time;
+};
 
 out vec3 FragPos;
 out vec3 Normal;
@@ -13,8 +20,8 @@ out vec2 TexCoord;
 
 void main() {
     FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    Normal = normalMatrix * aNormal;
     TexCoord = aTexCoord;
     
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    gl_Position = viewProjection * vec4(FragPos, 1.0);
 }
\ No newline at end of file
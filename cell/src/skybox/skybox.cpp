@@ -1,7 +1,8 @@
 #include "skybox.h"
 #include <iostream>
 #include <filesystem>
-#include "stbimage/stb_image.h"
+#include "image_decoder.h"
+#include "gl_state.h"
 
 namespace {
     // Skybox vertex positions
@@ -91,42 +92,44 @@ void Skybox::setupMesh() {
     glGenBuffers(1, &m_VBO);
     glGenBuffers(1, &m_EBO);
 
-    glBindVertexArray(m_VAO);
+    GLState::bindVertexArray(m_VAO);
 
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, m_VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), skyboxVertices, GL_STATIC_DRAW);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(skyboxIndices), skyboxIndices, GL_STATIC_DRAW);
 
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
 
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 }
 
 bool Skybox::loadCubemap() {
     auto faces = getDefaultTexturePaths();
 
+    // Decode all six faces in parallel; cubemap faces are not flipped
+    std::vector<ImageDecodeJob> jobs(faces.size());
+    for (size_t i = 0; i < faces.size(); i++) {
+        jobs[i].path = faces[i];
+        jobs[i].flipVertically = false;
+    }
+    std::vector<DecodedImage> images = ImageDecoder::decodeAll(jobs);
+
     glGenTextures(1, &m_CubemapTexture);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, m_CubemapTexture);
-
-    stbi_set_flip_vertically_on_load(false); // Important for cubemaps
-
-    int width, height, nrChannels;
-    for (unsigned int i = 0; i < faces.size(); i++) {
-        unsigned char* data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-        if (data) {
-            GLenum format = (nrChannels == 4) ? GL_RGBA : GL_RGB;
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-                0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-            stbi_image_free(data);
-        }
-        else {
+    GLState::bindTexture(0, GL_TEXTURE_CUBE_MAP, m_CubemapTexture);
+
+    for (unsigned int i = 0; i < images.size(); i++) {
+        const DecodedImage& image = images[i];
+        if (!image.isValid()) {
             std::cerr << "Cubemap texture failed to load at path: " << faces[i] << std::endl;
-            stbi_image_free(data);
             return false;
         }
+
+        GLenum format = (image.getChannels() == 4) ? GL_RGBA : GL_RGB;
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
+            0, format, image.getWidth(), image.getHeight(), 0, format, GL_UNSIGNED_BYTE, image.getPixels());
     }
 
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -140,34 +143,32 @@ bool Skybox::loadCubemap() {
 
 void Skybox::render(const Shader& shader) const {
     // Change depth function so depth test passes when values are equal to depth buffer's content
-    glDepthFunc(GL_LEQUAL);
+    GLState::setDepthFunc(GL_LEQUAL);
 
-    glBindVertexArray(m_VAO);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, m_CubemapTexture);
+    GLState::bindVertexArray(m_VAO);
+    GLState::bindTexture(0, GL_TEXTURE_CUBE_MAP, m_CubemapTexture);
 
     glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
 
-    glBindVertexArray(0);
-    // Set depth function back to default
-    glDepthFunc(GL_LESS);
+    // Set depth function back to default; the vertex array stays bound for whoever draws next
+    GLState::setDepthFunc(GL_LESS);
 }
 
 void Skybox::cleanup() {
     if (m_VAO != 0) {
-        glDeleteVertexArrays(1, &m_VAO);
+        GLState::deleteVertexArray(m_VAO);
         m_VAO = 0;
     }
     if (m_VBO != 0) {
-        glDeleteBuffers(1, &m_VBO);
+        GLState::deleteBuffer(m_VBO);
         m_VBO = 0;
     }
     if (m_EBO != 0) {
-        glDeleteBuffers(1, &m_EBO);
+        GLState::deleteBuffer(m_EBO);
         m_EBO = 0;
     }
     if (m_CubemapTexture != 0) {
-        glDeleteTextures(1, &m_CubemapTexture);
+        GLState::deleteTexture(m_CubemapTexture);
         m_CubemapTexture = 0;
     }
 }
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include "image_decoder.h"
+#include <stbimage/stb_image.h>
+#include <iostream>
+#include <utility>
+
+DecodedImage::DecodedImage()
+    : m_Pixels(nullptr)
+    , m_Width(0)
+    , m_Height(0)
+    , m_Channels(0)
+{
+}
+
+DecodedImage::DecodedImage(unsigned char* pixels, int width, int height, int channels)
+    : m_Pixels(pixels)
+    , m_Width(width)
+    , m_Height(height)
+    , m_Channels(channels)
+{
+}
+
+DecodedImage::~DecodedImage() {
+    release();
+}
+
+DecodedImage::DecodedImage(DecodedImage&& other) noexcept
+    : m_Pixels(std::exchange(other.m_Pixels, nullptr))
+    , m_Width(std::exchange(other.m_Width, 0))
+    , m_Height(std::exchange(other.m_Height, 0))
+    , m_Channels(std::exchange(other.m_Channels, 0))
+{
+}
+
+DecodedImage& DecodedImage::operator=(DecodedImage&& other) noexcept {
+    if (this != &other) {
+        release();
+        m_Pixels = std::exchange(other.m_Pixels, nullptr);
+        m_Width = std::exchange(other.m_Width, 0);
+        m_Height = std::exchange(other.m_Height, 0);
+        m_Channels = std::exchange(other.m_Channels, 0);
+    }
+    return *this;
+}
+
+void DecodedImage::release() {
+    if (m_Pixels) {
+        stbi_image_free(m_Pixels);
+        m_Pixels = nullptr;
+    }
+}
+
+DecodedImage ImageDecoder::decode(const ImageDecodeJob& job) {
+    // Thread-local in stb_image, so concurrent jobs cannot see each other's setting
+    stbi_set_flip_vertically_on_load_thread(job.flipVertically ? 1 : 0);
+
+    int width = 0, height = 0, channels = 0;
+    unsigned char* pixels = nullptr;
+    if (job.fileData) {
+        pixels = stbi_load_from_memory(job.fileData, static_cast<int>(job.fileSize),
+            &width, &height, &channels, 0);
+    }
+    else {
+        pixels = stbi_load(job.path.c_str(), &width, &height, &channels, 0);
+    }
+
+    if (!pixels) {
+        std::cerr << "Failed to decode image: " << job.path << std::endl;
+        std::cerr << "STB Error: " << stbi_failure_reason() << std::endl;
+        return DecodedImage();
+    }
+
+    return DecodedImage(pixels, width, height, channels);
+}
+
+std::vector<DecodedImage> ImageDecoder::decodeAll(const std::vector<ImageDecodeJob>& jobs) {
+    std::vector<DecodedImage> images(jobs.size());
+    if (jobs.empty()) {
+        return images;
+    }
+
+    // One image per chunk at most; each writes only its own slots. Loader tasks call this from
+    // the shared pool itself, which parallelFor allows.
+    ThreadPool::getShared().parallelFor(jobs.size(), 1, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; i++) {
+            images[i] = decode(jobs[i]);
+        }
+    });
+
+    return images;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "thread_pool.h"
+
+// CPU-side pixels produced by stb_image, released with stbi_image_free
+class DecodedImage {
+private:
+    unsigned char* m_Pixels;
+    int m_Width;
+    int m_Height;
+    int m_Channels;
+
+    void release();
+
+public:
+    DecodedImage();
+    DecodedImage(unsigned char* pixels, int width, int height, int channels);
+    ~DecodedImage();
+
+    // Move-only: exactly one owner frees the pixels
+    DecodedImage(const DecodedImage&) = delete;
+    DecodedImage& operator=(const DecodedImage&) = delete;
+    DecodedImage(DecodedImage&& other) noexcept;
+    DecodedImage& operator=(DecodedImage&& other) noexcept;
+
+    bool isValid() const { return m_Pixels != nullptr; }
+    const unsigned char* getPixels() const { return m_Pixels; }
+    int getWidth() const { return m_Width; }
+    int getHeight() const { return m_Height; }
+    int getChannels() const { return m_Channels; }
+};
+
+// One image to decode. The flip is per job so decodes with different
+// orientations (2D textures vs. cubemap faces) can run concurrently.
+struct ImageDecodeJob {
+    std::string path;
+    bool flipVertically = false;
+
+    // Optional encoded file already in memory (not owned); path is then only used in messages
+    const unsigned char* fileData = nullptr;
+    size_t fileSize = 0;
+};
+
+class ImageDecoder {
+public:
+    // Decodes on the calling thread; never touches stb_image's global flip state
+    static DecodedImage decode(const ImageDecodeJob& job);
+
+    // Fans the jobs out over the shared job pool (the caller decodes too) and blocks until
+    // all are done. Results line up with jobs; failures are invalid images.
+    static std::vector<DecodedImage> decodeAll(const std::vector<ImageDecodeJob>& jobs);
+};
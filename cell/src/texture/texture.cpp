@@ -1,7 +1,7 @@
 #include "texture.h"
-#include <stbimage/stb_image.h>
 #include <iostream>
 #include <filesystem>
+#include "gl_state.h"
 
 Texture::Texture()
     : m_TextureID(0)
@@ -9,6 +9,7 @@ Texture::Texture()
     , m_Height(0)
     , m_Channels(0)
     , m_Path("")
+    , m_SizeInBytes(0)
 {
 }
 
@@ -17,8 +18,15 @@ Texture::~Texture() {
 }
 
 bool Texture::loadTexture(const std::string& path) {
-    m_Path = path;
+    if (!loadImageData(path)) {
+        return false;
+    }
 
+    uploadToGPU();
+    return true;
+}
+
+bool Texture::loadImageData(const std::string& path) {
     std::cout << "Attempting to load texture from: " << path << std::endl;
 
     // Check if file exists
@@ -27,29 +35,121 @@ bool Texture::loadTexture(const std::string& path) {
         return false;
     }
 
-    // Load image using stb_image
-    stbi_set_flip_vertically_on_load(true);  
-    unsigned char* data = stbi_load(path.c_str(), &m_Width, &m_Height, &m_Channels, 0);
+    // Prefer the offline-cooked mip chain when it is present and current
+    CookedTexture cooked;
+    if (TextureCooker::read(path, cooked) && setCookedData(path, std::move(cooked))) {
+        return true;
+    }
+
+    // Textures are stored top-down, OpenGL samples bottom-up
+    ImageDecodeJob job;
+    job.path = path;
+    job.flipVertically = true;
+
+    return setImageData(path, ImageDecoder::decode(job));
+}
 
-    if (!data) {
+bool Texture::setImageData(const std::string& path, DecodedImage&& image) {
+    m_Path = path;
+
+    if (!image.isValid()) {
         std::cerr << "Failed to load texture: " << path << std::endl;
-        std::cerr << "STB Error: " << stbi_failure_reason() << std::endl;
         return false;
     }
 
+    m_Width = image.getWidth();
+    m_Height = image.getHeight();
+    m_Channels = image.getChannels();
+
+    // Full mip chain adds roughly a third on top of the base level
+    size_t baseLevel = static_cast<size_t>(m_Width) * m_Height * m_Channels;
+    m_SizeInBytes = baseLevel + baseLevel / 3;
+
+    // Keep the pixels until the render thread uploads them
+    m_Image = std::move(image);
+
+    return true;
+}
+
+bool Texture::setCookedData(const std::string& path, CookedTexture&& cooked) {
+    if (cooked.levels.empty()) {
+        return false;
+    }
+
+    // GLEW fills this in at glewInit, so it is safe to read from loader threads
+    if (cooked.format != CookedTextureFormat::RGBA8 && !GLEW_EXT_texture_compression_s3tc) {
+        return false;
+    }
+
+    m_Path = path;
+    m_Width = cooked.levels[0].width;
+    m_Height = cooked.levels[0].height;
+    m_Channels = cooked.sourceChannels;
+    m_SizeInBytes = cooked.getSizeInBytes();
+
+    m_Cooked = std::move(cooked);
+
+    return true;
+}
+
+void Texture::uploadToGPU() {
+    if (m_TextureID != 0) {
+        return;
+    }
+
+    if (!m_Cooked.levels.empty()) {
+        setupCookedTexture();
+        m_Cooked = CookedTexture();
+        return;
+    }
+
+    if (!m_Image.isValid()) {
+        return;
+    }
+
     // Setup texture in OpenGL
-    setupTexture(data);
+    setupTexture(m_Image.getPixels());
 
     // Free the image data
-    stbi_image_free(data);
+    m_Image = DecodedImage();
+}
 
-    return true;
+void Texture::setupCookedTexture() {
+    glGenTextures(1, &m_TextureID);
+    GLState::bindTexture(0, GL_TEXTURE_2D, m_TextureID);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(m_Cooked.levels.size() - 1));
+
+    // Every level was generated offline, so no glGenerateMipmap here
+    for (size_t i = 0; i < m_Cooked.levels.size(); i++) {
+        const CookedTextureLevel& level = m_Cooked.levels[i];
+        GLint mip = static_cast<GLint>(i);
+
+        switch (m_Cooked.format) {
+        case CookedTextureFormat::BC1:
+            glCompressedTexImage2D(GL_TEXTURE_2D, mip, GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+                level.width, level.height, 0, static_cast<GLsizei>(level.data.size()), level.data.data());
+            break;
+        case CookedTextureFormat::BC3:
+            glCompressedTexImage2D(GL_TEXTURE_2D, mip, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+                level.width, level.height, 0, static_cast<GLsizei>(level.data.size()), level.data.data());
+            break;
+        default:
+            glTexImage2D(GL_TEXTURE_2D, mip, GL_RGBA, level.width, level.height, 0,
+                GL_RGBA, GL_UNSIGNED_BYTE, level.data.data());
+            break;
+        }
+    }
 }
 
-void Texture::setupTexture(unsigned char* data) {
+void Texture::setupTexture(const unsigned char* data) {
     // Generate texture
     glGenTextures(1, &m_TextureID);
-    glBindTexture(GL_TEXTURE_2D, m_TextureID);
+    GLState::bindTexture(0, GL_TEXTURE_2D, m_TextureID);
 
     // Set texture parameters
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -74,18 +174,9 @@ void Texture::setupTexture(unsigned char* data) {
     glGenerateMipmap(GL_TEXTURE_2D);
 }
 
-void Texture::bind(unsigned int slot) const {
-    glActiveTexture(GL_TEXTURE0 + slot);
-    glBindTexture(GL_TEXTURE_2D, m_TextureID);
-}
-
-void Texture::unbind() const {
-    glBindTexture(GL_TEXTURE_2D, 0);
-}
-
 void Texture::cleanup() {
     if (m_TextureID != 0) {
-        glDeleteTextures(1, &m_TextureID);
+        GLState::deleteTexture(m_TextureID);
         m_TextureID = 0;
     }
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 #include <GL/glew.h>
 #include <string>
+#include "image_decoder.h"
+#include "texture_cook.h"
 
 class Texture {
 private:
@@ -9,8 +11,15 @@ private:
     int m_Height;
     int m_Channels;
     std::string m_Path;
+    size_t m_SizeInBytes;
 
-    void setupTexture(unsigned char* data);
+    // Decoded pixels waiting for upload; released once uploadToGPU has consumed them
+    DecodedImage m_Image;
+    // Precomputed mip chain from a .ctex, used instead of m_Image when present
+    CookedTexture m_Cooked;
+
+    void setupTexture(const unsigned char* data);
+    void setupCookedTexture();
     void cleanup();
 
 public:
@@ -23,12 +32,19 @@ public:
 
     // Core functionality
     bool loadTexture(const std::string& path);
-    void bind(unsigned int slot = 0) const;
-    void unbind() const;
+
+    // Two-stage loading: decode can run on any thread, upload needs the GL context
+    bool loadImageData(const std::string& path);
+    // Adopts pixels decoded elsewhere (e.g. by ImageDecoder::decodeAll)
+    bool setImageData(const std::string& path, DecodedImage&& image);
+    // Adopts a cooked mip chain; false if this GL context cannot sample its format
+    bool setCookedData(const std::string& path, CookedTexture&& cooked);
+    void uploadToGPU();
 
     // Getters
     int getWidth() const { return m_Width; }
     int getHeight() const { return m_Height; }
     GLuint getID() const { return m_TextureID; }
     const std::string& getPath() const { return m_Path; }
+    size_t getSizeInBytes() const { return m_SizeInBytes; }
 };
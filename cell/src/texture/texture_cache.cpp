@@ -0,0 +1,180 @@
+#include "texture_cache.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <vector>
+#include "image_decoder.h"
+
+namespace {
+    uint64_t hashBytes(const std::string& data) {
+        uint64_t hash = 14695981039346656037ull;
+        for (unsigned char byte : data) {
+            hash ^= byte;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    std::string resolvePath(const std::string& path) {
+        std::error_code ec;
+        std::filesystem::path resolved = std::filesystem::weakly_canonical(path, ec);
+        return ec ? path : resolved.generic_string();
+    }
+}
+
+TextureCache& TextureCache::get() {
+    static TextureCache instance;
+    return instance;
+}
+
+std::shared_ptr<Texture> TextureCache::resolveHit(const std::shared_ptr<Texture>& texture, const Entry& entry) {
+    // Another loader may still be decoding this image
+    if (!entry.decoded.get()) {
+        return nullptr;
+    }
+
+    m_Hits++;
+    m_BytesSaved += texture->getSizeInBytes();
+    return texture;
+}
+
+void TextureCache::pruneExpired() {
+    for (auto it = m_EntriesByPath.begin(); it != m_EntriesByPath.end();) {
+        it = it->second.texture.expired() ? m_EntriesByPath.erase(it) : std::next(it);
+    }
+    for (auto it = m_EntriesByContent.begin(); it != m_EntriesByContent.end();) {
+        it = it->second.texture.expired() ? m_EntriesByContent.erase(it) : std::next(it);
+    }
+}
+
+std::shared_ptr<Texture> TextureCache::acquire(const std::string& path) {
+    return acquire(std::vector<std::string>{ path })[0];
+}
+
+std::vector<std::shared_ptr<Texture>> TextureCache::acquire(const std::vector<std::string>& paths) {
+    // Outcome of looking one path up
+    struct Request {
+        Entry entry;
+        bool isHit = false;
+        // Held from the lookup on, so a hit cannot expire before it is resolved
+        std::shared_ptr<Texture> texture;
+        std::promise<bool> decodedPromise;
+        std::string encoded;
+    };
+
+    std::vector<std::shared_ptr<Texture>> results(paths.size());
+    std::vector<Request> requests(paths.size());
+    std::vector<ImageDecodeJob> jobs;
+    std::vector<size_t> jobRequests;
+
+    for (size_t i = 0; i < paths.size(); i++) {
+        const std::string& path = paths[i];
+        Request& request = requests[i];
+        std::string resolvedPath = resolvePath(path);
+
+        // Fast path: this exact file was already requested
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            auto it = m_EntriesByPath.find(resolvedPath);
+            if (it != m_EntriesByPath.end()) {
+                request.texture = it->second.texture.lock();
+            }
+            if (request.texture) {
+                request.entry = it->second;
+                request.isHit = true;
+                continue;
+            }
+        }
+
+        // Read the encoded file once: it is both hashed and decoded from memory
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Texture file does not exist at path: " << path << std::endl;
+            continue;
+        }
+        std::ostringstream stream;
+        stream << file.rdbuf();
+        request.encoded = stream.str();
+        uint64_t contentHash = hashBytes(request.encoded);
+
+        // An offline-cooked mip chain, if present, replaces the decode entirely
+        CookedTexture cooked;
+        bool hasCooked = TextureCooker::read(path, cooked);
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        // Same bytes under another name
+        auto it = m_EntriesByContent.find(contentHash);
+        if (it != m_EntriesByContent.end()) {
+            request.texture = it->second.texture.lock();
+        }
+        if (request.texture) {
+            request.entry = it->second;
+            request.isHit = true;
+            m_EntriesByPath[resolvedPath] = request.entry;
+            request.encoded.clear();
+            continue;
+        }
+
+        // Miss: this call owns the decode, other requesters wait on the future
+        pruneExpired();
+        request.texture = std::make_shared<Texture>();
+        request.entry.texture = request.texture;
+        request.entry.decoded = request.decodedPromise.get_future().share();
+        m_EntriesByPath[resolvedPath] = request.entry;
+        m_EntriesByContent[contentHash] = request.entry;
+        m_Misses++;
+
+        if (hasCooked && request.texture->setCookedData(path, std::move(cooked))) {
+            request.decodedPromise.set_value(true);
+            results[i] = request.texture;
+            request.encoded.clear();
+            continue;
+        }
+
+        ImageDecodeJob job;
+        job.path = path;
+        job.flipVertically = true;
+        job.fileData = reinterpret_cast<const unsigned char*>(request.encoded.data());
+        job.fileSize = request.encoded.size();
+        jobs.push_back(job);
+        jobRequests.push_back(i);
+    }
+
+    // Decode every miss of this batch in parallel
+    std::vector<DecodedImage> images = ImageDecoder::decodeAll(jobs);
+    for (size_t j = 0; j < jobs.size(); j++) {
+        Request& request = requests[jobRequests[j]];
+        bool decoded = request.texture->setImageData(jobs[j].path, std::move(images[j]));
+        request.decodedPromise.set_value(decoded);
+        if (decoded) {
+            results[jobRequests[j]] = request.texture;
+        }
+    }
+
+    // Hits are resolved last so they can wait on decodes owned by this same batch
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (requests[i].isHit) {
+            results[i] = resolveHit(requests[i].texture, requests[i].entry);
+        }
+    }
+
+    return results;
+}
+
+TextureCache::Stats TextureCache::getStats() const {
+    Stats stats;
+    stats.hits = m_Hits.load();
+    stats.misses = m_Misses.load();
+    stats.bytesSaved = m_BytesSaved.load();
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    stats.liveTextures = 0;
+    for (const auto& [hash, entry] : m_EntriesByContent) {
+        if (!entry.texture.expired()) {
+            stats.liveTextures++;
+        }
+    }
+    return stats;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "texture.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <future>
+#include <atomic>
+#include <cstdint>
+
+// Process-wide cache so every image is decoded and held in VRAM once.
+// Textures are keyed by resolved path, and by content hash so identical files
+// under different names share one texture. Entries are weak: a texture is
+// released once the last material using it goes away.
+class TextureCache {
+public:
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t bytesSaved;  // Decoded bytes (including mips) that hits did not allocate again
+        size_t liveTextures;
+    };
+
+private:
+    struct Entry {
+        std::weak_ptr<Texture> texture;
+        std::shared_future<bool> decoded;  // Ready once the first requester finished decoding
+    };
+
+    mutable std::mutex m_Mutex;
+    std::unordered_map<std::string, Entry> m_EntriesByPath;
+    std::unordered_map<uint64_t, Entry> m_EntriesByContent;
+
+    std::atomic<uint64_t> m_Hits{ 0 };
+    std::atomic<uint64_t> m_Misses{ 0 };
+    std::atomic<uint64_t> m_BytesSaved{ 0 };
+
+    TextureCache() = default;
+
+    std::shared_ptr<Texture> resolveHit(const std::shared_ptr<Texture>& texture, const Entry& entry);
+    void pruneExpired();
+
+public:
+    static TextureCache& get();
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    // Returns the shared texture for path, decoding it on first use. Safe to call from loader threads;
+    // the returned texture still needs uploadToGPU on the render thread. Null if the image failed to decode.
+    std::shared_ptr<Texture> acquire(const std::string& path);
+
+    // Batch form: every miss in the batch is decoded in parallel. Results line up with paths.
+    std::vector<std::shared_ptr<Texture>> acquire(const std::vector<std::string>& paths);
+
+    Stats getStats() const;
+};
@@ -0,0 +1,476 @@
+#include "texture_cook.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    const char COOKED_TEXTURE_MAGIC[4] = { 'C', 'T', 'E', 'X' };
+
+    struct CookedTextureHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t format;
+        uint32_t sourceChannels;
+        uint32_t levelCount;
+        uint32_t width;   // Of level 0
+        uint32_t height;
+        uint32_t reserved;
+        uint64_t sourceSize;
+        int64_t sourceTimestamp;
+    };
+
+    struct LevelHeader {
+        uint32_t width;
+        uint32_t height;
+        uint32_t dataSize;
+        uint32_t reserved;
+    };
+
+    using Texel = std::array<unsigned char, 4>;
+
+    // sRGB <-> linear conversion so mip filtering does not darken the image
+    const std::array<float, 256>& getSrgbToLinearTable() {
+        static const std::array<float, 256> table = []() {
+            std::array<float, 256> values{};
+            for (int i = 0; i < 256; i++) {
+                float c = i / 255.0f;
+                values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            return values;
+        }();
+        return table;
+    }
+
+    unsigned char linearToSrgb(float linear) {
+        linear = std::clamp(linear, 0.0f, 1.0f);
+        float c = linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+        return static_cast<unsigned char>(std::lround(c * 255.0f));
+    }
+
+    std::vector<unsigned char> expandToRGBA(const DecodedImage& image) {
+        size_t texelCount = static_cast<size_t>(image.getWidth()) * image.getHeight();
+        int channels = image.getChannels();
+        const unsigned char* src = image.getPixels();
+
+        std::vector<unsigned char> rgba(texelCount * 4);
+        for (size_t i = 0; i < texelCount; i++) {
+            const unsigned char* texel = src + i * channels;
+            unsigned char* out = &rgba[i * 4];
+            if (channels >= 3) {
+                out[0] = texel[0];
+                out[1] = texel[1];
+                out[2] = texel[2];
+            }
+            else {
+                // Grey (+ alpha)
+                out[0] = out[1] = out[2] = texel[0];
+            }
+            out[3] = channels == 4 ? texel[3] : (channels == 2 ? texel[1] : 255);
+        }
+        return rgba;
+    }
+
+    // 2x2 box filter in linear space; odd edges reuse the last row/column
+    CookedTextureLevel downsample(const CookedTextureLevel& src) {
+        const auto& toLinear = getSrgbToLinearTable();
+
+        CookedTextureLevel dst;
+        dst.width = std::max(1, src.width / 2);
+        dst.height = std::max(1, src.height / 2);
+        dst.data.resize(static_cast<size_t>(dst.width) * dst.height * 4);
+
+        for (int y = 0; y < dst.height; y++) {
+            int y0 = std::min(y * 2, src.height - 1);
+            int y1 = std::min(y * 2 + 1, src.height - 1);
+            for (int x = 0; x < dst.width; x++) {
+                int x0 = std::min(x * 2, src.width - 1);
+                int x1 = std::min(x * 2 + 1, src.width - 1);
+                const unsigned char* texels[4] = {
+                    &src.data[(static_cast<size_t>(y0) * src.width + x0) * 4],
+                    &src.data[(static_cast<size_t>(y0) * src.width + x1) * 4],
+                    &src.data[(static_cast<size_t>(y1) * src.width + x0) * 4],
+                    &src.data[(static_cast<size_t>(y1) * src.width + x1) * 4],
+                };
+
+                unsigned char* out = &dst.data[(static_cast<size_t>(y) * dst.width + x) * 4];
+                for (int c = 0; c < 3; c++) {
+                    float sum = 0.0f;
+                    for (const unsigned char* texel : texels) {
+                        sum += toLinear[texel[c]];
+                    }
+                    out[c] = linearToSrgb(sum * 0.25f);
+                }
+                int alphaSum = texels[0][3] + texels[1][3] + texels[2][3] + texels[3][3];
+                out[3] = static_cast<unsigned char>((alphaSum + 2) / 4);
+            }
+        }
+        return dst;
+    }
+
+    uint16_t packRGB565(float r, float g, float b) {
+        int r5 = std::clamp(static_cast<int>(std::lround(r * 31.0f / 255.0f)), 0, 31);
+        int g6 = std::clamp(static_cast<int>(std::lround(g * 63.0f / 255.0f)), 0, 63);
+        int b5 = std::clamp(static_cast<int>(std::lround(b * 31.0f / 255.0f)), 0, 31);
+        return static_cast<uint16_t>((r5 << 11) | (g6 << 5) | b5);
+    }
+
+    std::array<float, 3> unpackRGB565(uint16_t color) {
+        int r5 = (color >> 11) & 31;
+        int g6 = (color >> 5) & 63;
+        int b5 = color & 31;
+        return { (r5 << 3 | r5 >> 2) * 1.0f, (g6 << 2 | g6 >> 4) * 1.0f, (b5 << 3 | b5 >> 2) * 1.0f };
+    }
+
+    // BC1 color block: endpoints along the principal axis of the block's colors, always 4-color mode
+    void encodeColorBlock(const Texel (&block)[16], unsigned char* out) {
+        float mean[3] = {};
+        for (const Texel& texel : block) {
+            for (int c = 0; c < 3; c++) mean[c] += texel[c];
+        }
+        for (float& m : mean) m /= 16.0f;
+
+        float covariance[6] = {};  // xx, xy, xz, yy, yz, zz
+        for (const Texel& texel : block) {
+            float d[3] = { texel[0] - mean[0], texel[1] - mean[1], texel[2] - mean[2] };
+            covariance[0] += d[0] * d[0];
+            covariance[1] += d[0] * d[1];
+            covariance[2] += d[0] * d[2];
+            covariance[3] += d[1] * d[1];
+            covariance[4] += d[1] * d[2];
+            covariance[5] += d[2] * d[2];
+        }
+
+        // Power iteration for the dominant eigenvector
+        float axis[3] = { 1.0f, 1.0f, 1.0f };
+        for (int iteration = 0; iteration < 8; iteration++) {
+            float next[3] = {
+                covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2],
+                covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2],
+                covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2],
+            };
+            float length = std::max({ std::abs(next[0]), std::abs(next[1]), std::abs(next[2]) });
+            if (length < 1e-6f) break;
+            for (int c = 0; c < 3; c++) axis[c] = next[c] / length;
+        }
+
+        int minIndex = 0, maxIndex = 0;
+        float minProjection = 1e30f, maxProjection = -1e30f;
+        for (int i = 0; i < 16; i++) {
+            float projection = block[i][0] * axis[0] + block[i][1] * axis[1] + block[i][2] * axis[2];
+            if (projection < minProjection) { minProjection = projection; minIndex = i; }
+            if (projection > maxProjection) { maxProjection = projection; maxIndex = i; }
+        }
+
+        uint16_t color0 = packRGB565(block[maxIndex][0], block[maxIndex][1], block[maxIndex][2]);
+        uint16_t color1 = packRGB565(block[minIndex][0], block[minIndex][1], block[minIndex][2]);
+        // color0 > color1 selects the 4-color mode
+        if (color0 < color1) {
+            std::swap(color0, color1);
+        }
+
+        uint32_t indices = 0;
+        if (color0 != color1) {
+            auto p0 = unpackRGB565(color0);
+            auto p1 = unpackRGB565(color1);
+            std::array<float, 3> palette[4] = { p0, p1, {}, {} };
+            for (int c = 0; c < 3; c++) {
+                palette[2][c] = (2.0f * p0[c] + p1[c]) / 3.0f;
+                palette[3][c] = (p0[c] + 2.0f * p1[c]) / 3.0f;
+            }
+
+            for (int i = 0; i < 16; i++) {
+                uint32_t best = 0;
+                float bestDistance = 1e30f;
+                for (uint32_t p = 0; p < 4; p++) {
+                    float distance = 0.0f;
+                    for (int c = 0; c < 3; c++) {
+                        float d = block[i][c] - palette[p][c];
+                        distance += d * d;
+                    }
+                    if (distance < bestDistance) { bestDistance = distance; best = p; }
+                }
+                indices |= best << (2 * i);
+            }
+        }
+
+        out[0] = static_cast<unsigned char>(color0 & 0xFF);
+        out[1] = static_cast<unsigned char>(color0 >> 8);
+        out[2] = static_cast<unsigned char>(color1 & 0xFF);
+        out[3] = static_cast<unsigned char>(color1 >> 8);
+        for (int i = 0; i < 4; i++) {
+            out[4 + i] = static_cast<unsigned char>((indices >> (8 * i)) & 0xFF);
+        }
+    }
+
+    // BC3 alpha block: min/max endpoints in 8-value mode, 3-bit indices
+    void encodeAlphaBlock(const Texel (&block)[16], unsigned char* out) {
+        unsigned char alpha0 = 0, alpha1 = 255;
+        for (const Texel& texel : block) {
+            alpha0 = std::max(alpha0, texel[3]);
+            alpha1 = std::min(alpha1, texel[3]);
+        }
+
+        uint64_t indices = 0;
+        if (alpha0 != alpha1) {
+            float palette[8] = { static_cast<float>(alpha0), static_cast<float>(alpha1) };
+            for (int i = 1; i < 7; i++) {
+                palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7.0f;
+            }
+
+            for (int i = 0; i < 16; i++) {
+                uint64_t best = 0;
+                float bestDistance = 1e30f;
+                for (uint64_t p = 0; p < 8; p++) {
+                    float distance = std::abs(block[i][3] - palette[p]);
+                    if (distance < bestDistance) { bestDistance = distance; best = p; }
+                }
+                indices |= best << (3 * i);
+            }
+        }
+
+        out[0] = alpha0;
+        out[1] = alpha1;
+        for (int i = 0; i < 6; i++) {
+            out[2 + i] = static_cast<unsigned char>((indices >> (8 * i)) & 0xFF);
+        }
+    }
+
+    void compressLevel(const CookedTextureLevel& rgba, CookedTextureFormat format, std::vector<unsigned char>& out) {
+        int blocksX = (rgba.width + 3) / 4;
+        int blocksY = (rgba.height + 3) / 4;
+        size_t blockSize = format == CookedTextureFormat::BC1 ? 8 : 16;
+        out.assign(static_cast<size_t>(blocksX) * blocksY * blockSize, 0);
+
+        for (int by = 0; by < blocksY; by++) {
+            for (int bx = 0; bx < blocksX; bx++) {
+                // Gather the 4x4 block, clamping at the edges of small mips
+                Texel block[16];
+                for (int y = 0; y < 4; y++) {
+                    int sy = std::min(by * 4 + y, rgba.height - 1);
+                    for (int x = 0; x < 4; x++) {
+                        int sx = std::min(bx * 4 + x, rgba.width - 1);
+                        std::memcpy(block[y * 4 + x].data(), &rgba.data[(static_cast<size_t>(sy) * rgba.width + sx) * 4], 4);
+                    }
+                }
+
+                unsigned char* dst = &out[(static_cast<size_t>(by) * blocksX + bx) * blockSize];
+                if (format == CookedTextureFormat::BC3) {
+                    encodeAlphaBlock(block, dst);
+                    dst += 8;
+                }
+                encodeColorBlock(block, dst);
+            }
+        }
+    }
+
+    bool stampSource(const std::string& sourcePath, uint64_t& size, int64_t& timestamp) {
+        std::error_code ec;
+        auto writeTime = std::filesystem::last_write_time(sourcePath, ec);
+        if (ec) return false;
+        auto fileSize = std::filesystem::file_size(sourcePath, ec);
+        if (ec) return false;
+
+        size = static_cast<uint64_t>(fileSize);
+        timestamp = static_cast<int64_t>(writeTime.time_since_epoch().count());
+        return true;
+    }
+}
+
+size_t CookedTexture::getSizeInBytes() const {
+    size_t total = 0;
+    for (const auto& level : levels) {
+        total += level.data.size();
+    }
+    return total;
+}
+
+std::string TextureCooker::getCookedPath(const std::string& sourcePath) {
+    return std::filesystem::path(sourcePath).replace_extension(".ctex").string();
+}
+
+uint32_t TextureCooker::getMaxLevelCount(uint32_t width, uint32_t height) {
+    // floor(log2(max(width, height))) + 1
+    uint32_t levels = 1;
+    for (uint32_t size = std::max(width, height); size > 1; size /= 2) {
+        levels++;
+    }
+    return levels;
+}
+
+size_t TextureCooker::getLevelSize(CookedTextureFormat format, int width, int height) {
+    switch (format) {
+    case CookedTextureFormat::BC1:
+        return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * 8;
+    case CookedTextureFormat::BC3:
+        return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * 16;
+    default:
+        return static_cast<size_t>(width) * height * 4;
+    }
+}
+
+bool TextureCooker::cook(const DecodedImage& image, bool compress, CookedTexture& cooked) {
+    if (!image.isValid()) {
+        return false;
+    }
+
+    // Full chain down to 1x1, all in RGBA8
+    std::vector<CookedTextureLevel> rgbaLevels(1);
+    rgbaLevels[0].width = image.getWidth();
+    rgbaLevels[0].height = image.getHeight();
+    rgbaLevels[0].data = expandToRGBA(image);
+    while (rgbaLevels.back().width > 1 || rgbaLevels.back().height > 1) {
+        rgbaLevels.push_back(downsample(rgbaLevels.back()));
+    }
+
+    cooked.sourceChannels = image.getChannels();
+    cooked.format = CookedTextureFormat::RGBA8;
+    if (compress) {
+        bool hasAlpha = false;
+        const auto& base = rgbaLevels[0].data;
+        for (size_t i = 3; i < base.size() && !hasAlpha; i += 4) {
+            hasAlpha = base[i] != 255;
+        }
+        cooked.format = hasAlpha ? CookedTextureFormat::BC3 : CookedTextureFormat::BC1;
+    }
+
+    cooked.levels.clear();
+    for (auto& rgba : rgbaLevels) {
+        CookedTextureLevel level;
+        level.width = rgba.width;
+        level.height = rgba.height;
+        if (cooked.format == CookedTextureFormat::RGBA8) {
+            level.data = std::move(rgba.data);
+        }
+        else {
+            compressLevel(rgba, cooked.format, level.data);
+        }
+        cooked.levels.push_back(std::move(level));
+    }
+
+    return true;
+}
+
+bool TextureCooker::write(const std::string& sourcePath, const CookedTexture& cooked) {
+    CookedTextureHeader header{};
+    std::memcpy(header.magic, COOKED_TEXTURE_MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.format = static_cast<uint32_t>(cooked.format);
+    header.sourceChannels = static_cast<uint32_t>(cooked.sourceChannels);
+    header.levelCount = static_cast<uint32_t>(cooked.levels.size());
+    if (!cooked.levels.empty()) {
+        header.width = static_cast<uint32_t>(cooked.levels[0].width);
+        header.height = static_cast<uint32_t>(cooked.levels[0].height);
+    }
+    if (!stampSource(sourcePath, header.sourceSize, header.sourceTimestamp)) {
+        std::cerr << "Texture source does not exist: " << sourcePath << std::endl;
+        return false;
+    }
+
+    std::string cookedPath = getCookedPath(sourcePath);
+    std::string tempPath = cookedPath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open cooked texture for writing: " << tempPath << std::endl;
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const auto& level : cooked.levels) {
+            LevelHeader levelHeader{};
+            levelHeader.width = static_cast<uint32_t>(level.width);
+            levelHeader.height = static_cast<uint32_t>(level.height);
+            levelHeader.dataSize = static_cast<uint32_t>(level.data.size());
+            file.write(reinterpret_cast<const char*>(&levelHeader), sizeof(levelHeader));
+            file.write(reinterpret_cast<const char*>(level.data.data()), level.data.size());
+        }
+
+        if (!file.good()) {
+            std::cerr << "Failed to write cooked texture: " << tempPath << std::endl;
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, cookedPath, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+bool TextureCooker::read(const std::string& sourcePath, CookedTexture& cooked) {
+    std::ifstream file(getCookedPath(sourcePath), std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    uint64_t remaining = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+
+    CookedTextureHeader header{};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, COOKED_TEXTURE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != VERSION ||
+        header.format > static_cast<uint32_t>(CookedTextureFormat::BC3)) {
+        return false;
+    }
+    remaining -= sizeof(header);
+
+    // Everything below sizes allocations, so a corrupt or truncated file must fail here
+    // rather than throw on the loader thread
+    if (header.width == 0 || header.height == 0 || header.width > MAX_DIMENSION || header.height > MAX_DIMENSION ||
+        header.levelCount == 0 ||
+        header.levelCount > getMaxLevelCount(header.width, header.height)) {
+        return false;
+    }
+
+    // A source edited after cooking wins over the stale cooked copy
+    uint64_t sourceSize = 0;
+    int64_t sourceTimestamp = 0;
+    if (stampSource(sourcePath, sourceSize, sourceTimestamp) &&
+        (sourceSize != header.sourceSize || sourceTimestamp != header.sourceTimestamp)) {
+        return false;
+    }
+
+    cooked.format = static_cast<CookedTextureFormat>(header.format);
+    cooked.sourceChannels = static_cast<int>(header.sourceChannels);
+    cooked.levels.clear();
+    cooked.levels.reserve(header.levelCount);
+
+    uint32_t expectedWidth = header.width;
+    uint32_t expectedHeight = header.height;
+    for (uint32_t i = 0; i < header.levelCount; i++) {
+        LevelHeader levelHeader{};
+        if (remaining < sizeof(levelHeader) ||
+            !file.read(reinterpret_cast<char*>(&levelHeader), sizeof(levelHeader))) {
+            return false;
+        }
+        remaining -= sizeof(levelHeader);
+
+        // Level 0 is the header size, each later level halves it
+        if (levelHeader.width != expectedWidth || levelHeader.height != expectedHeight ||
+            levelHeader.dataSize != getLevelSize(cooked.format, levelHeader.width, levelHeader.height) ||
+            levelHeader.dataSize > remaining) {
+            return false;
+        }
+        remaining -= levelHeader.dataSize;
+        expectedWidth = std::max(1u, expectedWidth / 2);
+        expectedHeight = std::max(1u, expectedHeight / 2);
+
+        CookedTextureLevel level;
+        level.width = static_cast<int>(levelHeader.width);
+        level.height = static_cast<int>(levelHeader.height);
+        level.data.resize(levelHeader.dataSize);
+        if (!file.read(reinterpret_cast<char*>(level.data.data()), level.data.size())) {
+            return false;
+        }
+        cooked.levels.push_back(std::move(level));
+    }
+
+    return !cooked.levels.empty();
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "image_decoder.h"
+
+// Payload encoding of a cooked texture. Values are stored in the .ctex file.
+enum class CookedTextureFormat : uint32_t {
+    RGBA8 = 0,  // Uncompressed, 4 bytes per texel
+    BC1 = 1,    // DXT1: opaque RGB, 8 bytes per 4x4 block
+    BC3 = 2,    // DXT5: RGB + interpolated alpha, 16 bytes per 4x4 block
+};
+
+struct CookedTextureLevel {
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> data;
+};
+
+// A full mip chain, bottom-up (already flipped for OpenGL)
+struct CookedTexture {
+    CookedTextureFormat format = CookedTextureFormat::RGBA8;
+    int sourceChannels = 0;
+    std::vector<CookedTextureLevel> levels;
+
+    size_t getSizeInBytes() const;
+};
+
+// Builds, writes and reads .ctex files. Has no GL dependency so the offline
+// cooker (tools/texcook) can run headless.
+class TextureCooker {
+public:
+    static constexpr uint32_t VERSION = 2;
+    // Larger cooked textures are treated as corrupt; keeps level sizes well inside int range
+    static constexpr uint32_t MAX_DIMENSION = 1 << 16;
+
+    // "gamedata/textures/stone.jpg" -> "gamedata/textures/stone.ctex"
+    static std::string getCookedPath(const std::string& sourcePath);
+
+    // Mip chain is filtered in linear space and stored as sRGB. With compress set, images
+    // with any translucent texel become BC3 and opaque ones BC1; otherwise RGBA8.
+    static bool cook(const DecodedImage& image, bool compress, CookedTexture& cooked);
+
+    // Writes cooked next to sourcePath, stamped with the source's size and timestamp
+    static bool write(const std::string& sourcePath, const CookedTexture& cooked);
+
+    // Fails if the .ctex is missing, from another version, or older than its source
+    static bool read(const std::string& sourcePath, CookedTexture& cooked);
+
+    static size_t getLevelSize(CookedTextureFormat format, int width, int height);
+    // Length of the full mip chain of a width x height image
+    static uint32_t getMaxLevelCount(uint32_t width, uint32_t height);
+};
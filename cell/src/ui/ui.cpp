@@ -7,11 +7,14 @@
 #include "camera.h"
 #include "scene.h"
 #include "model_manager.h"
+#include "texture_cache.h"
+#include "gl_state.h"
 
 UI::UI(GLFWwindow* window)
     : m_Window(window)
     , m_ShowDemoWindow(true)
     , m_CurrentItem(0)
+    , m_SelectionGeneration(0)
     , m_PlayerMode(false)
 {
     refreshModelList();
@@ -76,6 +79,34 @@ void UI::render(Camera& camera) {
             1000.0f / ImGui::GetIO().Framerate,
             ImGui::GetIO().Framerate);
 
+        TextureCache::Stats textureStats = TextureCache::get().getStats();
+        ImGui::Text("Textures: %zu live, %llu hits / %llu misses, %.1f MB saved",
+            textureStats.liveTextures,
+            static_cast<unsigned long long>(textureStats.hits),
+            static_cast<unsigned long long>(textureStats.misses),
+            textureStats.bytesSaved / (1024.0 * 1024.0));
+
+        if (m_ModelManager) {
+            const ModelManager::CullStats& cullStats = m_ModelManager->getCullStats();
+            ImGui::Text("Models: %zu visible, %zu culled (%.3f ms)",
+                cullStats.visible, cullStats.culled, cullStats.cullMs);
+
+            bool frustumCulling = m_ModelManager->isFrustumCullingEnabled();
+            if (ImGui::Checkbox("Frustum Culling", &frustumCulling)) {
+                m_ModelManager->setFrustumCullingEnabled(frustumCulling);
+            }
+        }
+
+        if (m_RenderQueue) {
+            const RenderQueue::Stats& queueStats = m_RenderQueue->getStats();
+            ImGui::Text("Draws: %zu (binds: %zu program, %zu texture, %zu VAO), sort %.3f ms",
+                queueStats.draws, queueStats.programBinds, queueStats.textureBinds,
+                queueStats.vertexArrayBinds, queueStats.sortMs);
+        }
+
+        const GLState::Stats& glStats = GLState::getFrameStats();
+        ImGui::Text("GL state calls: %zu issued, %zu filtered", glStats.issued, glStats.filtered);
+
         ImGui::Separator();
 
         ImGui::Text("Camera Controls");
@@ -118,6 +149,7 @@ void UI::render(Camera& camera) {
                 if (std::find(m_SelectedModels.begin(), m_SelectedModels.end(),
                     m_ModelFiles[m_CurrentItem]) == m_SelectedModels.end()) {
                     m_SelectedModels.push_back(m_ModelFiles[m_CurrentItem]);
+                    m_SelectionGeneration++;
                 }
             }
         }
@@ -138,6 +170,7 @@ void UI::render(Camera& camera) {
 
             if (ImGui::Button("Remove")) {
                 it = m_SelectedModels.erase(it);
+                m_SelectionGeneration++;
             }
             else {
                 ++it;
@@ -7,8 +7,10 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <cstdint>
 #include "camera.h"
 #include "model_manager.h"
+#include "render_queue.h"
 #include "player.h"
 
 class UI {
@@ -19,9 +21,11 @@ private:
     std::vector<std::string> m_ModelFiles;        
     std::vector<std::string> m_SelectedModels;   
     int m_CurrentItem;                            
+    uint64_t m_SelectionGeneration;  // Bumped on every change to m_SelectedModels
 
     void refreshModelList();
     ModelManager* m_ModelManager = nullptr;
+    const RenderQueue* m_RenderQueue = nullptr;
 
     std::function<void()> m_SaveSceneCallback = nullptr;
 
@@ -41,11 +45,14 @@ public:
     void toggleDemoWindow() { m_ShowDemoWindow = !m_ShowDemoWindow; }
 
     const std::vector<std::string>& getSelectedModels() const { return m_SelectedModels; }
+    uint64_t getSelectionGeneration() const { return m_SelectionGeneration; }
 
     void setModelManager(ModelManager* manager) { m_ModelManager = manager; }
+    void setRenderQueue(const RenderQueue* queue) { m_RenderQueue = queue; }
 
     void updateSelectedModels(const std::vector<std::string>& modelNames) {
         m_SelectedModels = modelNames;
+        m_SelectionGeneration++;
     }
 
     void setSaveSceneCallback(std::function<void()> callback) {
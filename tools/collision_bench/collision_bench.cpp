@@ -0,0 +1,586 @@
+// collision_bench: headless collision benchmark. Builds synthetic worlds in memory (grid
+// floors, heightfields, random triangle soups) at sizes from 1K triangles up, adds the game's
+// .obj models (or those given on the command line) along with their collision proxies, and times the
+// collision pipeline on each: mesh build (triangle extraction, BVH, SAT precompute), the SAT
+// kernel at every SIMD level, BVH queries, box and swept queries, a CollisionWorld step and
+// batched raycasts. Grid worlds are measured a second time through the heightfield shape.
+// Results are written as JSON.
+//
+// Headless, no GL required. Build on Linux from the repository root with (one command):
+//   g++ -std=c++20 -O2 -pthread -Idependencies -Icell/src/collision -Icell/src/jobs -Icell/src/model
+//       tools/collision_bench/collision_bench.cpp cell/src/collision/*.cpp cell/src/jobs/thread_pool.cpp
+//       cell/src/model/mesh_cache.cpp cell/src/tinyobj.cpp -o collision_bench
+//
+// Usage: collision_bench [--max-triangles N] [--output results.json] [model.obj or directory]...
+//   With no model given, the game's models are measured: gamedata/models, or cell/gamedata/models
+//   when run from the repository root
+//   --max-triangles  largest synthetic world; sizes grow tenfold from 1000 (default 10000000)
+//   --output         write the JSON there instead of stdout
+// Collision meshes take about 256 bytes per triangle; the 10M worlds peak near 3.5 GB.
+
+#include "collision_mesh.h"
+#include "collision_world.h"
+#include "sat_kernel.h"
+#include "collision_proxy.h"
+#include "mesh_cache.h"
+#include "tinyobj/tiny_obj_loader.h"
+#include <json/json.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Query boxes are player sized
+    const glm::vec3 QUERY_HALF_EXTENTS(0.4f);
+    constexpr size_t QUERY_COUNT = 4096;
+    constexpr size_t WORLD_BODY_COUNT = 256;
+    constexpr int WORLD_STEP_COUNT = 30;
+    constexpr float RAY_LENGTH = 100.0f;
+    // Repeated measurements run at least this long
+    constexpr double MIN_SECONDS = 0.25;
+
+    struct BenchMesh {
+        std::string name;
+        std::vector<float> vertices;
+        size_t vertexStride = 3;
+        std::vector<unsigned int> indices;
+    };
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // Seconds per call of body, repeated until MIN_SECONDS have passed
+    template <typename Body>
+    double timePerCall(Body&& body) {
+        size_t calls = 0;
+        Clock::time_point start = Clock::now();
+        do {
+            body();
+            calls++;
+        } while (secondsSince(start) < MIN_SECONDS);
+        return secondsSince(start) / calls;
+    }
+
+    // Unit-spaced grid of size x size quads; height(x, z) lifts each vertex
+    template <typename Height>
+    BenchMesh makeGrid(const std::string& name, size_t size, Height&& height) {
+        BenchMesh mesh;
+        mesh.name = name;
+        mesh.vertices.reserve((size + 1) * (size + 1) * 3);
+        mesh.indices.reserve(size * size * 6);
+
+        float offset = size * 0.5f;
+        for (size_t z = 0; z <= size; z++) {
+            for (size_t x = 0; x <= size; x++) {
+                float worldX = x - offset;
+                float worldZ = z - offset;
+                mesh.vertices.insert(mesh.vertices.end(), { worldX, height(worldX, worldZ), worldZ });
+            }
+        }
+
+        for (size_t z = 0; z < size; z++) {
+            for (size_t x = 0; x < size; x++) {
+                unsigned int corner = static_cast<unsigned int>(z * (size + 1) + x);
+                unsigned int right = corner + 1;
+                unsigned int below = corner + static_cast<unsigned int>(size + 1);
+                mesh.indices.insert(mesh.indices.end(), { corner, below, right, right, below, below + 1 });
+            }
+        }
+        return mesh;
+    }
+
+    BenchMesh makeFloor(size_t triangleCount) {
+        size_t size = std::max<size_t>(1, static_cast<size_t>(std::sqrt(triangleCount / 2.0)));
+        return makeGrid("grid", size, [](float, float) { return 0.0f; });
+    }
+
+    BenchMesh makeHeightfield(size_t triangleCount) {
+        size_t size = std::max<size_t>(1, static_cast<size_t>(std::sqrt(triangleCount / 2.0)));
+        return makeGrid("heightfield", size, [](float x, float z) {
+            return 2.0f * std::sin(x * 0.15f) * std::cos(z * 0.1f) + 0.5f * std::sin(x * 0.7f + z * 0.9f);
+        });
+    }
+
+    // Independent triangles of about 1 m, at the same density for every size
+    BenchMesh makeSoup(size_t triangleCount, std::mt19937& rng) {
+        BenchMesh mesh;
+        mesh.name = "soup";
+        float extent = 2.0f * std::cbrt(static_cast<float>(triangleCount));
+        std::uniform_real_distribution<float> position(-extent * 0.5f, extent * 0.5f);
+        std::uniform_real_distribution<float> corner(-0.75f, 0.75f);
+
+        mesh.vertices.reserve(triangleCount * 9);
+        mesh.indices.reserve(triangleCount * 3);
+        for (size_t i = 0; i < triangleCount; i++) {
+            glm::vec3 center(position(rng), position(rng), position(rng));
+            for (int v = 0; v < 3; v++) {
+                mesh.vertices.insert(mesh.vertices.end(), { center.x + corner(rng), center.y + corner(rng), center.z + corner(rng) });
+                mesh.indices.push_back(static_cast<unsigned int>(i * 3 + v));
+            }
+        }
+        return mesh;
+    }
+
+    // Positions only; the cooked .cmesh is used when it is current, and its collision proxy, if
+    // any, goes to proxy so both can be compared
+    bool loadModel(const std::string& path, BenchMesh& mesh, BenchMesh& proxy) {
+        mesh.name = std::filesystem::path(path).filename().string();
+
+        CookedMeshData cooked;
+        if (MeshCache::read(path, cooked)) {
+            cooked.buffers.copyPositions(mesh.vertices, mesh.indices);
+            mesh.vertexStride = 3;
+            proxy.name = mesh.name + " (proxy)";
+            proxy.vertices = std::move(cooked.collisionVertices);
+            proxy.vertexStride = 3;
+            proxy.indices = std::move(cooked.collisionIndices);
+            return true;
+        }
+
+        tinyobj::attrib_t attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t> materials;
+        std::string warn, err;
+        std::string baseDir = std::filesystem::path(path).parent_path().string() + "/";
+        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str(), baseDir.c_str())) {
+            std::cerr << "Failed to load model: " << path << " " << err << std::endl;
+            return false;
+        }
+
+        // Authored _col shapes are the proxy, as in Model::processModelData, never the render mesh
+        for (const auto& shape : shapes) {
+            BenchMesh& target = CollisionProxy::isCollisionShapeName(shape.name) ? proxy : mesh;
+            for (const tinyobj::index_t& index : shape.mesh.indices) {
+                target.indices.push_back(static_cast<unsigned int>(index.vertex_index));
+            }
+        }
+        if (!proxy.indices.empty()) {
+            proxy.name = mesh.name + " (proxy)";
+            proxy.vertices = attrib.vertices;
+            proxy.vertexStride = 3;
+        }
+        mesh.vertices = std::move(attrib.vertices);
+        mesh.vertexStride = 3;
+        return true;
+    }
+
+    // A point on a random triangle, pushed off the surface by up to 0.3 m, and that triangle's normal
+    struct SurfaceSample {
+        glm::vec3 point;
+        glm::vec3 normal;
+    };
+
+    std::vector<SurfaceSample> sampleSurface(const CollisionMesh& mesh, size_t count, std::mt19937& rng) {
+        std::vector<SurfaceSample> samples;
+        if (mesh.getTriangleCount() == 0) {
+            return samples;
+        }
+
+        std::uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(mesh.getTriangleCount() - 1));
+        std::uniform_real_distribution<float> lift(-0.3f, 0.3f);
+        samples.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            CollisionTriangle triangle = mesh.getTriangle(pick(rng));
+            glm::vec3 centroid = (triangle.v0 + triangle.v1 + triangle.v2) / 3.0f;
+            samples.push_back({ centroid + triangle.normal * lift(rng), triangle.normal });
+        }
+        return samples;
+    }
+
+    CollisionBounds boxAround(const glm::vec3& center, const glm::vec3& halfExtents) {
+        CollisionBounds bounds;
+        bounds.min = center - halfExtents;
+        bounds.max = center + halfExtents;
+        return bounds;
+    }
+
+    json benchBuild(const BenchMesh& input, CollisionMesh& mesh) {
+        json result;
+        size_t repeats = input.indices.size() / 3 >= 1000000 ? 1 : 3;
+
+        // The two expensive stages on their own, timed first so their copies are gone before the mesh is built
+        {
+            std::vector<CollisionTriangle> triangles;
+            std::vector<CollisionBounds> triangleBounds;
+            Clock::time_point start = Clock::now();
+            for (size_t i = 0; i + 2 < input.indices.size(); i += 3) {
+                CollisionTriangle triangle;
+                triangle.v0 = glm::make_vec3(&input.vertices[input.indices[i] * input.vertexStride]);
+                triangle.v1 = glm::make_vec3(&input.vertices[input.indices[i + 1] * input.vertexStride]);
+                triangle.v2 = glm::make_vec3(&input.vertices[input.indices[i + 2] * input.vertexStride]);
+                triangles.push_back(triangle);
+
+                CollisionBounds bounds;
+                bounds.grow(triangle.v0);
+                bounds.grow(triangle.v1);
+                bounds.grow(triangle.v2);
+                triangleBounds.push_back(bounds);
+            }
+            result["extractMs"] = secondsSince(start) * 1e3;
+
+            double bvhSeconds = 1e30;
+            for (size_t i = 0; i < repeats; i++) {
+                BVH bvh;
+                start = Clock::now();
+                bvh.build(triangleBounds);
+                bvhSeconds = std::min(bvhSeconds, secondsSince(start));
+            }
+            result["bvhBuildMs"] = bvhSeconds * 1e3;
+            std::vector<CollisionBounds>().swap(triangleBounds);
+
+            double precomputeSeconds = 1e30;
+            for (size_t i = 0; i < repeats; i++) {
+                CollisionTriangleSoA precomputed;
+                start = Clock::now();
+                precomputed.assign(triangles);
+                precomputeSeconds = std::min(precomputeSeconds, secondsSince(start));
+            }
+            result["satPrecomputeMs"] = precomputeSeconds * 1e3;
+        }
+
+        // Whole pipeline: triangle extraction, BVH build, leaf reordering and SAT precompute.
+        // Grid detection is off so every world measures the generic triangle path.
+        double buildSeconds = 1e30;
+        for (size_t i = 0; i < repeats; i++) {
+            Clock::time_point start = Clock::now();
+            mesh.build(input.vertices, input.vertexStride, input.indices, false);
+            buildSeconds = std::min(buildSeconds, secondsSince(start));
+        }
+
+        result["meshBuildMs"] = buildSeconds * 1e3;
+        result["memoryBytes"] = mesh.getMemoryUsage();
+        result["bytesPerTriangle"] = mesh.getTriangleCount() ? static_cast<double>(mesh.getMemoryUsage()) / mesh.getTriangleCount() : 0.0;
+        return result;
+    }
+
+    // Brute force over every triangle: the kernel's raw throughput
+    json benchSATLevels(const CollisionMesh& mesh, const std::vector<SurfaceSample>& samples) {
+        json result;
+        const CollisionTriangleSoA& triangles = mesh.getTriangles();
+        std::vector<TriangleRange> everything{ { 0, static_cast<uint32_t>(triangles.count) } };
+        std::vector<uint32_t> hits;
+
+        SATKernel::Level previous = SATKernel::getLevel();
+        for (int level = 0; level <= static_cast<int>(SATKernel::getSupportedLevel()); level++) {
+            SATKernel::setLevel(static_cast<SATKernel::Level>(level));
+            size_t sample = 0;
+            double seconds = timePerCall([&]() {
+                hits.clear();
+                SATKernel::overlapBox(triangles, everything, samples[sample++ % samples.size()].point, QUERY_HALF_EXTENTS, hits);
+            });
+            result[SATKernel::getLevelName(static_cast<SATKernel::Level>(level))] = triangles.count / seconds * 1e-6;
+        }
+        SATKernel::setLevel(previous);
+        return result;
+    }
+
+    json benchQueries(const CollisionMesh& mesh, const std::vector<SurfaceSample>& samples, std::mt19937& rng) {
+        json result;
+        std::vector<TriangleRange> ranges;
+        std::vector<uint32_t> hits;
+
+        // BVH traversal only
+        size_t candidates = 0;
+        size_t queries = 0;
+        double seconds = timePerCall([&]() {
+            for (const SurfaceSample& sample : samples) {
+                ranges.clear();
+                mesh.collectLeaves(boxAround(sample.point, QUERY_HALF_EXTENTS), ranges);
+                for (const TriangleRange& range : ranges) {
+                    candidates += range.count;
+                }
+            }
+            queries += samples.size();
+        });
+        result["bvhQuery"] = {
+            { "queriesPerSecond", samples.size() / seconds },
+            { "candidatesPerQuery", static_cast<double>(candidates) / queries },
+        };
+
+        // Traversal plus the SAT kernel on the candidates
+        size_t hitCount = 0;
+        queries = 0;
+        seconds = timePerCall([&]() {
+            for (const SurfaceSample& sample : samples) {
+                ranges.clear();
+                hits.clear();
+                mesh.collectLeaves(boxAround(sample.point, QUERY_HALF_EXTENTS), ranges);
+                SATKernel::overlapBox(mesh.getTriangles(), ranges, sample.point, QUERY_HALF_EXTENTS, hits);
+                hitCount += hits.size();
+            }
+            queries += samples.size();
+        });
+        result["boxQuery"] = {
+            { "queriesPerSecond", samples.size() / seconds },
+            { "hitsPerQuery", static_cast<double>(hitCount) / queries },
+        };
+
+        // Swept boxes falling onto the surface from 1.5 m with some sideways drift
+        std::uniform_real_distribution<float> drift(-1.0f, 1.0f);
+        std::vector<glm::vec3> displacements;
+        displacements.reserve(samples.size());
+        for (const SurfaceSample& sample : samples) {
+            displacements.push_back(-sample.normal * 3.0f + glm::vec3(drift(rng), 0.0f, drift(rng)));
+        }
+
+        size_t sweepHits = 0;
+        queries = 0;
+        seconds = timePerCall([&]() {
+            for (size_t i = 0; i < samples.size(); i++) {
+                glm::vec3 start = samples[i].point + samples[i].normal * 1.5f;
+                CollisionBounds sweptBounds = boxAround(start, QUERY_HALF_EXTENTS);
+                sweptBounds.grow(boxAround(start + displacements[i], QUERY_HALF_EXTENTS));
+
+                ranges.clear();
+                mesh.collectLeaves(sweptBounds, ranges);
+                SweepHit hit;
+                if (SATKernel::sweepBox(mesh.getTriangles(), ranges, start, QUERY_HALF_EXTENTS, displacements[i], hit)) {
+                    sweepHits++;
+                }
+            }
+            queries += samples.size();
+        });
+        result["sweep"] = {
+            { "sweepsPerSecond", samples.size() / seconds },
+            { "hitRate", static_cast<double>(sweepHits) / queries },
+        };
+        return result;
+    }
+
+    // Bodies falling onto the mesh through the full CollisionWorld path, including the job pool
+    json benchWorld(std::shared_ptr<const CollisionMesh> mesh, const std::vector<SurfaceSample>& samples) {
+        CollisionWorld world;
+        world.getScene().setInstance(1, mesh, glm::mat4(1.0f));
+        world.getScene().update();
+
+        size_t bodyCount = std::min(WORLD_BODY_COUNT, samples.size());
+        for (size_t i = 0; i < bodyCount; i++) {
+            world.setBody(i, samples[i].point + samples[i].normal * 1.0f, QUERY_HALF_EXTENTS);
+        }
+
+        Clock::time_point start = Clock::now();
+        for (int step = 0; step < WORLD_STEP_COUNT; step++) {
+            for (size_t i = 0; i < bodyCount; i++) {
+                world.moveBody(i, glm::vec3(0.02f, -0.15f, 0.01f));
+            }
+            world.step();
+        }
+        double seconds = secondsSince(start) / WORLD_STEP_COUNT;
+
+        return {
+            { "bodies", bodyCount },
+            { "stepMs", seconds * 1e3 },
+            { "contacts", world.getContacts().size() },
+        };
+    }
+
+    // Batched CollisionWorld::raycast at every SIMD level. Half the rays aim at a surface sample
+    // from 2 m off it, half leave it in a random direction, so both hits and misses are measured.
+    json benchRaycast(std::shared_ptr<const CollisionMesh> mesh, const std::vector<SurfaceSample>& samples, std::mt19937& rng) {
+        CollisionWorld world;
+        world.getScene().setInstance(1, mesh, glm::mat4(1.0f));
+        world.getScene().update();
+
+        std::uniform_real_distribution<float> axis(-1.0f, 1.0f);
+        std::vector<CollisionRay> rays;
+        rays.reserve(samples.size());
+        for (size_t i = 0; i < samples.size(); i++) {
+            glm::vec3 origin = samples[i].point + samples[i].normal * 2.0f;
+            glm::vec3 direction = -samples[i].normal;
+            glm::vec3 random(axis(rng), axis(rng), axis(rng));
+            if (i % 2 == 1 && glm::length(random) > 1e-3f) {
+                direction = glm::normalize(random);
+            }
+            rays.push_back(CollisionRay::segment(origin, origin + direction * RAY_LENGTH));
+        }
+
+        std::vector<RaycastHit> hits;
+        json raysPerSecond;
+        SATKernel::Level previous = SATKernel::getLevel();
+        for (int level = 0; level <= static_cast<int>(SATKernel::getSupportedLevel()); level++) {
+            SATKernel::setLevel(static_cast<SATKernel::Level>(level));
+            double seconds = timePerCall([&]() {
+                world.raycast(rays, hits);
+            });
+            raysPerSecond[SATKernel::getLevelName(static_cast<SATKernel::Level>(level))] = rays.size() / seconds;
+        }
+        SATKernel::setLevel(previous);
+
+        size_t hitCount = std::count_if(hits.begin(), hits.end(), [](const RaycastHit& hit) { return hit.hit; });
+        return {
+            { "rays", rays.size() },
+            { "raysPerSecond", raysPerSecond },
+            { "hitFraction", static_cast<double>(hitCount) / rays.size() },
+        };
+    }
+
+    // Grid worlds again, through the heightfield CollisionMesh picks for them by default; null if not a grid
+    json benchHeightfield(const BenchMesh& input, const std::vector<SurfaceSample>& samples, std::mt19937& rng) {
+        CollisionHeightfield heightfield;
+        Clock::time_point start = Clock::now();
+        if (!heightfield.detect(input.vertices, input.vertexStride, input.indices)) {
+            return nullptr;
+        }
+
+        json result;
+        result["detectMs"] = secondsSince(start) * 1e3;
+        result["memoryBytes"] = heightfield.getMemoryUsage();
+        result["bytesPerTriangle"] = static_cast<double>(heightfield.getMemoryUsage()) / heightfield.getTriangleCount();
+
+        size_t candidates = 0;
+        size_t queries = 0;
+        double seconds = timePerCall([&]() {
+            for (const SurfaceSample& sample : samples) {
+                heightfield.query(boxAround(sample.point, QUERY_HALF_EXTENTS), [&](uint32_t, const CollisionTriangle&) {
+                    candidates++;
+                });
+            }
+            queries += samples.size();
+        });
+        result["cellQuery"] = {
+            { "queriesPerSecond", samples.size() / seconds },
+            { "candidatesPerQuery", static_cast<double>(candidates) / queries },
+        };
+
+        float heightSum = 0.0f;
+        seconds = timePerCall([&]() {
+            for (const SurfaceSample& sample : samples) {
+                float height;
+                if (heightfield.getHeight(sample.point.x, sample.point.z, height)) {
+                    heightSum += height;
+                }
+            }
+        });
+        result["groundHeightQueriesPerSecond"] = samples.size() / seconds;
+        // Keeps the loop above from being optimized away
+        result["checksum"] = heightSum;
+
+        auto mesh = std::make_shared<CollisionMesh>();
+        mesh->build(std::move(heightfield));
+        result["worldStep"] = benchWorld(mesh, samples);
+        result["raycast"] = benchRaycast(mesh, samples, rng);
+        return result;
+    }
+
+    json benchMesh(const BenchMesh& input, std::mt19937& rng) {
+        std::cerr << "Benchmarking " << input.name << " (" << input.indices.size() / 3 << " triangles)" << std::endl;
+
+        json result;
+        result["world"] = input.name;
+        result["inputTriangles"] = input.indices.size() / 3;
+
+        auto mesh = std::make_shared<CollisionMesh>();
+        result["build"] = benchBuild(input, *mesh);
+        result["triangles"] = mesh->getTriangleCount();
+
+        std::vector<SurfaceSample> samples = sampleSurface(*mesh, QUERY_COUNT, rng);
+        if (samples.empty()) {
+            return result;
+        }
+
+        result["satMTrianglesPerSecond"] = benchSATLevels(*mesh, samples);
+        result.update(benchQueries(*mesh, samples, rng));
+        result["worldStep"] = benchWorld(mesh, samples);
+        result["raycast"] = benchRaycast(mesh, samples, rng);
+
+        json heightfield = benchHeightfield(input, samples, rng);
+        if (!heightfield.is_null()) {
+            result["heightfield"] = heightfield;
+        }
+        return result;
+    }
+
+    // A single .obj, or every .obj directly inside a directory
+    void addModels(const std::string& path, std::vector<std::string>& modelPaths) {
+        if (!std::filesystem::is_directory(path)) {
+            modelPaths.push_back(path);
+            return;
+        }
+        for (const auto& entry : std::filesystem::directory_iterator(path)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".obj") {
+                modelPaths.push_back(entry.path().string());
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t maxTriangles = 10000000;
+    std::string outputPath;
+    std::vector<std::string> modelPaths;
+    bool hasModelArgument = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--max-triangles") == 0 && i + 1 < argc) {
+            maxTriangles = std::stoull(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        }
+        else {
+            addModels(argv[i], modelPaths);
+            hasModelArgument = true;
+        }
+    }
+    if (!hasModelArgument) {
+        for (const char* directory : { "gamedata/models", "cell/gamedata/models" }) {
+            if (std::filesystem::is_directory(directory)) {
+                addModels(directory, modelPaths);
+                break;
+            }
+        }
+    }
+    std::sort(modelPaths.begin(), modelPaths.end());
+
+    // Fixed seed so nightly runs measure the same worlds
+    std::mt19937 rng(12345);
+
+    json report;
+    report["satLevel"] = SATKernel::getLevelName(SATKernel::getSupportedLevel());
+    report["workerThreads"] = ThreadPool::getShared().getThreadCount();
+    report["results"] = json::array();
+
+    for (size_t size = 1000; size <= maxTriangles; size *= 10) {
+        // One world at a time keeps peak memory to the largest mesh
+        report["results"].push_back(benchMesh(makeFloor(size), rng));
+        report["results"].push_back(benchMesh(makeHeightfield(size), rng));
+        report["results"].push_back(benchMesh(makeSoup(size, rng), rng));
+    }
+
+    for (const std::string& path : modelPaths) {
+        BenchMesh mesh;
+        BenchMesh proxy;
+        if (loadModel(path, mesh, proxy)) {
+            report["results"].push_back(benchMesh(mesh, rng));
+            if (!proxy.indices.empty()) {
+                report["results"].push_back(benchMesh(proxy, rng));
+            }
+        }
+    }
+
+    if (outputPath.empty()) {
+        std::cout << report.dump(2) << std::endl;
+        return 0;
+    }
+
+    std::ofstream file(outputPath);
+    if (!file.is_open()) {
+        std::cerr << "Failed to write results to: " << outputPath << std::endl;
+        return 1;
+    }
+    file << report.dump(2) << std::endl;
+    return 0;
+}
@@ -0,0 +1,118 @@
+// texcook: offline texture cooker. Writes a .ctex next to every source image holding a
+// gamma-correct mip chain, BC1/BC3-compressed by default. Texture picks the .ctex up at
+// load time and falls back to decoding the source image when it is missing or stale.
+//
+// Headless, no GL required. Build on Linux from the repository root with (one command):
+//   g++ -std=c++20 -O2 -pthread -Idependencies -Icell/src/texture -Icell/src/jobs
+//       tools/texcook/texcook.cpp cell/src/texture/texture_cook.cpp cell/src/texture/image_decoder.cpp
+//       cell/src/jobs/thread_pool.cpp cell/src/stb.cpp -o texcook
+//
+// Usage: texcook [--raw] [--force] <image or directory>...
+//   --raw    store uncompressed RGBA8 mips instead of BC1/BC3
+//   --force  re-cook images whose .ctex is already up to date
+
+#include "texture_cook.h"
+#include "image_decoder.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <latch>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+    bool isImageFile(const std::filesystem::path& path) {
+        std::string extension = path.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+            [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return extension == ".jpg" || extension == ".jpeg" || extension == ".png" ||
+            extension == ".tga" || extension == ".bmp";
+    }
+
+    const char* getFormatName(CookedTextureFormat format) {
+        switch (format) {
+        case CookedTextureFormat::BC1: return "BC1";
+        case CookedTextureFormat::BC3: return "BC3";
+        default: return "RGBA8";
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    bool compress = true;
+    bool force = false;
+    std::vector<std::string> sources;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--raw") == 0) {
+            compress = false;
+        }
+        else if (std::strcmp(argv[i], "--force") == 0) {
+            force = true;
+        }
+        else if (std::filesystem::is_directory(argv[i])) {
+            for (const auto& entry : std::filesystem::directory_iterator(argv[i])) {
+                if (entry.is_regular_file() && isImageFile(entry.path())) {
+                    sources.push_back(entry.path().string());
+                }
+            }
+        }
+        else {
+            sources.push_back(argv[i]);
+        }
+    }
+
+    if (sources.empty()) {
+        std::cerr << "Usage: texcook [--raw] [--force] <image or directory>..." << std::endl;
+        return 1;
+    }
+    std::sort(sources.begin(), sources.end());
+
+    // One image per pool task; stdout is shared so reports are serialized
+    std::atomic<int> failures{ 0 };
+    std::mutex outputMutex;
+    std::latch remaining(static_cast<std::ptrdiff_t>(sources.size()));
+
+    for (const auto& source : sources) {
+        ThreadPool::getShared().submit([&, source]() {
+            CookedTexture existing;
+            if (!force && TextureCooker::read(source, existing)) {
+                std::lock_guard<std::mutex> lock(outputMutex);
+                std::cout << source << ": up to date" << std::endl;
+                remaining.count_down();
+                return;
+            }
+
+            // Same orientation the runtime uses for 2D textures
+            ImageDecodeJob job;
+            job.path = source;
+            job.flipVertically = true;
+            DecodedImage image = ImageDecoder::decode(job);
+
+            CookedTexture cooked;
+            bool success = TextureCooker::cook(image, compress, cooked) && TextureCooker::write(source, cooked);
+
+            {
+                std::lock_guard<std::mutex> lock(outputMutex);
+                if (success) {
+                    size_t sourceBytes = static_cast<size_t>(image.getWidth()) * image.getHeight() * image.getChannels();
+                    std::cout << source << " -> " << TextureCooker::getCookedPath(source)
+                        << " (" << getFormatName(cooked.format) << ", " << cooked.levels.size() << " levels, "
+                        << sourceBytes / 1024 << " KB base level -> " << cooked.getSizeInBytes() / 1024
+                        << " KB with mips)" << std::endl;
+                }
+                else {
+                    std::cerr << source << ": failed to cook" << std::endl;
+                    failures++;
+                }
+            }
+            remaining.count_down();
+        });
+    }
+
+    remaining.wait();
+    return failures.load() == 0 ? 0 : 1;
+}